@@ -0,0 +1,392 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cstdlib>
+#include<new>
+#include<atomic>
+#include<ostream>
+#include<algorithm>
+#include<string_view>
+#include<cstring>
+
+#if defined(_MSC_VER)
+#include<intrin.h>
+#define CPPTF_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define CPPTF_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+#if __has_include(<dlfcn.h>)
+#include<dlfcn.h>
+#define CPPTF_HAS_DLADDR 1
+#endif
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include<windows.h>
+#define CPPTF_HAS_BACKTRACE 1
+#elif __has_include(<execinfo.h>)
+#include<execinfo.h>
+#define CPPTF_HAS_BACKTRACE 1
+#endif
+
+#if __has_include(<cxxabi.h>)
+#include<cxxabi.h>
+#define CPPTF_HAS_DEMANGLE 1
+#endif
+
+// Allocation tracking for assertNoAllocations / assertMaxAllocations.
+//
+// Opt-in: in exactly ONE translation unit of the test binary write
+//     #define CPPTF_TRACK_ALLOCATIONS
+//     #include "AllocationTracker/AllocationTracker.h"
+// which replaces the global operator new/delete. Every other TU just includes the header.
+// Counting only happens on threads inside an AllocationScope, so the rest of the program only pays
+// for one thread_local check per allocation.
+//
+// The call site of a counted allocation is the first frame of a short backtrace that is not part of the
+// allocator machinery (operator new, these hooks, std:: and __gnu_cxx:: code such as std::allocator or
+// vector growth), so a push_back in a test is charged to the test, not to std::allocator<T>::allocate.
+// Telling the frames apart needs their symbols: link the test binary with exported symbols
+// (ENABLE_EXPORTS / -rdynamic), otherwise every frame of the executable counts as a call site.
+
+// One call site of operator new (the return address inside the first caller outside the allocator)
+struct AllocationSite {
+    const void* address = nullptr;
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+};
+
+// Per-thread counters. Constant initialised and trivially destructible, so operator new can touch
+// them at any time (even during static initialisation) without recursing into the allocator.
+struct AllocationCounters {
+    static constexpr std::size_t maxSites = 64;
+
+    int activeScopes = 0;
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t deallocations = 0;
+    std::size_t droppedSites = 0;   // allocations from call sites that did not fit into sites[]
+    AllocationSite sites[maxSites] = {};
+
+    // Entry of site (open addressing on its address, no allocation allowed in here); null when sites[] is full
+    AllocationSite* slotFor(const void* site) {
+        const std::size_t slot = (reinterpret_cast<std::uintptr_t>(site) >> 4) % maxSites;
+        for (std::size_t probe = 0; probe < maxSites; ++probe) {
+            AllocationSite& entry = sites[(slot + probe) % maxSites];
+            if (entry.address == site || entry.address == nullptr) {
+                entry.address = site;
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    void record(std::size_t size, const void* site) {
+        ++allocations;
+        bytes += size;
+        if (AllocationSite* entry = slotFor(site)) {
+            ++entry->count;
+            entry->bytes += size;
+        }
+        else {
+            ++droppedSites;
+        }
+    }
+
+    // Add the counts of a nested scope
+    void merge(const AllocationCounters& inner) {
+        allocations += inner.allocations;
+        bytes += inner.bytes;
+        deallocations += inner.deallocations;
+        droppedSites += inner.droppedSites;
+        for (const AllocationSite& site : inner.sites) {
+            if (site.address == nullptr) {
+                continue;
+            }
+            if (AllocationSite* entry = slotFor(site.address)) {
+                entry->count += site.count;
+                entry->bytes += site.bytes;
+            }
+            else {
+                droppedSites += site.count;
+            }
+        }
+    }
+};
+
+namespace cpptf_allocation_detail {
+    // Mangled names of the frames skipped when looking for the call site
+    inline bool isAllocatorSymbol(std::string_view name) {
+        constexpr std::string_view prefixes[] = {
+            "_Znw", "_Zna",                                    // operator new / new[]
+            "_ZSt", "_ZNSt", "_ZNKSt",                         // std::
+            "_ZN9__gnu_cxx", "_ZNK9__gnu_cxx",                 // libstdc++ internals (__new_allocator, ...)
+            "_ZNSt3__1", "_ZNKSt3__1",                         // libc++
+            "_ZN17AllocationTracker", "_ZN22cpptf_allocation_hooks",
+        };
+        for (std::string_view prefix : prefixes) {
+            if (name.substr(0, prefix.size()) == prefix) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool isAllocatorFrame(const void* address) {
+#ifdef CPPTF_HAS_DLADDR
+        Dl_info info;
+        if (dladdr(address, &info) == 0) {
+            return false;
+        }
+        if (info.dli_sname != nullptr) {
+            return isAllocatorSymbol(info.dli_sname);
+        }
+        // No symbol: code inside the C++ runtime library is allocator code, anything else is a caller
+        return info.dli_fname != nullptr && (std::strstr(info.dli_fname, "libstdc++") != nullptr || std::strstr(info.dli_fname, "libc++") != nullptr);
+#else
+        (void)address;
+        return false;
+#endif
+    }
+
+    // Per-thread memo of isAllocatorFrame, direct mapped; constant initialised like AllocationCounters
+    struct FrameCache {
+        static constexpr std::size_t size = 256;
+        const void* address[size] = {};
+        bool allocator[size] = {};
+
+        bool isAllocator(const void* frame) {
+            const std::size_t slot = (reinterpret_cast<std::uintptr_t>(frame) >> 2) % size;
+            if (address[slot] != frame) {
+                address[slot] = frame;
+                allocator[slot] = isAllocatorFrame(frame);
+            }
+            return allocator[slot];
+        }
+    };
+}
+
+class AllocationTracker {
+public:
+    inline static thread_local AllocationCounters counters{};
+    inline static thread_local cpptf_allocation_detail::FrameCache frames{};
+
+    static constexpr int maxFrames = 24;  // deep enough for unoptimised std::vector growth
+
+    // Set by the TU that defines CPPTF_TRACK_ALLOCATIONS
+    inline static std::atomic<bool> hooksInstalled{ false };
+
+    static bool enabled() { return hooksInstalled.load(std::memory_order_relaxed); }
+
+    // fallback is the return address inside operator new's caller, used when no backtrace is available
+    static void onAllocate(std::size_t size, const void* fallback) {
+        AllocationCounters& local = counters;
+        if (local.activeScopes > 0) {
+            local.record(size, callSite(fallback));
+        }
+    }
+
+    // First frame of the current stack outside the allocator machinery
+    static const void* callSite(const void* fallback) {
+#ifdef CPPTF_HAS_BACKTRACE
+        void* stack[maxFrames];
+#if defined(_WIN32)
+        const int depth = static_cast<int>(CaptureStackBackTrace(0, maxFrames, stack, nullptr));
+#else
+        const int depth = backtrace(stack, maxFrames);
+#endif
+        cpptf_allocation_detail::FrameCache& cache = frames;
+        for (int i = 0; i < depth; ++i) {
+            if (!cache.isAllocator(stack[i])) {
+                return stack[i];
+            }
+        }
+#endif
+        return fallback;
+    }
+
+    static void onDeallocate() {
+        AllocationCounters& local = counters;
+        if (local.activeScopes > 0) {
+            ++local.deallocations;
+        }
+    }
+};
+
+// Counts the allocations made by the current thread while the scope is alive.
+// Scopes nest: an inner scope counts from zero, and what it counted is added to the enclosing scope when it ends.
+class AllocationScope {
+private:
+    AllocationCounters saved;
+
+public:
+    AllocationScope() : saved(AllocationTracker::counters) {
+        AllocationCounters& local = AllocationTracker::counters;
+        local = AllocationCounters{};
+        local.activeScopes = saved.activeScopes + 1;
+    }
+
+    ~AllocationScope() {
+        AllocationCounters& local = AllocationTracker::counters;
+        if (saved.activeScopes > 0) {
+            saved.merge(local);
+        }
+        local = saved;
+    }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    // Snapshot of what was counted so far
+    AllocationCounters counters() const {
+        AllocationCounters result = AllocationTracker::counters;
+        result.activeScopes = 0;
+        return result;
+    }
+};
+
+// "N allocations, B bytes" followed by the heaviest call sites
+inline void writeAllocationBreakdown(std::ostream& os, const AllocationCounters& counters, std::size_t maxSitesShown = 8) {
+    os << counters.allocations << " allocations, " << counters.bytes << " bytes";
+
+    AllocationSite sorted[AllocationCounters::maxSites];
+    std::size_t used = 0;
+    for (const AllocationSite& site : counters.sites) {
+        if (site.address != nullptr) {
+            sorted[used++] = site;
+        }
+    }
+    std::sort(sorted, sorted + used, [](const AllocationSite& a, const AllocationSite& b) { return a.count > b.count; });
+
+    for (std::size_t i = 0; i < std::min(used, maxSitesShown); ++i) {
+        os << (i == 0 ? "; call sites: " : ", ") << sorted[i].address;
+#ifdef CPPTF_HAS_DLADDR
+        Dl_info info;
+        const bool found = dladdr(sorted[i].address, &info) != 0;
+        if (found && info.dli_sname != nullptr) {
+#ifdef CPPTF_HAS_DEMANGLE
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            os << " <" << (status == 0 && demangled != nullptr ? demangled : info.dli_sname) << ">";
+            std::free(demangled);
+#else
+            os << " <" << info.dli_sname << ">";
+#endif
+        }
+        else if (found && info.dli_fname != nullptr) {
+            // Local function (lambda, static): module and offset, for addr2line -e <module> <offset>
+            std::string_view module = info.dli_fname;
+            module = module.substr(module.find_last_of('/') + 1);
+            os << " <" << module << "+0x" << std::hex
+                << (reinterpret_cast<std::uintptr_t>(sorted[i].address) - reinterpret_cast<std::uintptr_t>(info.dli_fbase)) << std::dec << ">";
+        }
+#endif
+        os << " x" << sorted[i].count << " (" << sorted[i].bytes << " B)";
+    }
+    if (used > maxSitesShown) {
+        os << ", " << used - maxSitesShown << " more sites";
+    }
+    if (counters.droppedSites > 0) {
+        os << ", " << counters.droppedSites << " allocations from untracked sites";
+    }
+}
+
+
+#if defined(CPPTF_TRACK_ALLOCATIONS) && !defined(CPPTF_ALLOCATION_HOOKS_DEFINED)
+#define CPPTF_ALLOCATION_HOOKS_DEFINED
+
+namespace cpptf_allocation_hooks {
+    inline void* allocate(std::size_t size, const void* site) {
+        AllocationTracker::onAllocate(size, site);
+        void* memory = std::malloc(size == 0 ? 1 : size);
+        return memory;
+    }
+
+    inline void* allocateAligned(std::size_t size, std::align_val_t alignment, const void* site) {
+        AllocationTracker::onAllocate(size, site);
+        const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        const std::size_t rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+        return std::aligned_alloc(align, rounded);
+#endif
+    }
+
+    inline void release(void* memory) {
+        if (memory != nullptr) {
+            AllocationTracker::onDeallocate();
+            std::free(memory);
+        }
+    }
+
+    inline void releaseAligned(void* memory) {
+        if (memory != nullptr) {
+            AllocationTracker::onDeallocate();
+#if defined(_MSC_VER)
+            _aligned_free(memory);
+#else
+            std::free(memory);
+#endif
+        }
+    }
+
+    struct Installer {
+        Installer() {
+            AllocationTracker::hooksInstalled.store(true, std::memory_order_relaxed);
+#if defined(CPPTF_HAS_BACKTRACE) && !defined(_WIN32)
+            // The first backtrace() loads the unwinder; do it now rather than inside a counted scope
+            void* frame[1];
+            backtrace(frame, 1);
+#endif
+        }
+    };
+    static Installer installer;
+}
+
+void* operator new(std::size_t size) {
+    if (void* memory = cpptf_allocation_hooks::allocate(size, CPPTF_RETURN_ADDRESS())) return memory;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* memory = cpptf_allocation_hooks::allocate(size, CPPTF_RETURN_ADDRESS())) return memory;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return cpptf_allocation_hooks::allocate(size, CPPTF_RETURN_ADDRESS());
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return cpptf_allocation_hooks::allocate(size, CPPTF_RETURN_ADDRESS());
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* memory = cpptf_allocation_hooks::allocateAligned(size, alignment, CPPTF_RETURN_ADDRESS())) return memory;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* memory = cpptf_allocation_hooks::allocateAligned(size, alignment, CPPTF_RETURN_ADDRESS())) return memory;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return cpptf_allocation_hooks::allocateAligned(size, alignment, CPPTF_RETURN_ADDRESS());
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return cpptf_allocation_hooks::allocateAligned(size, alignment, CPPTF_RETURN_ADDRESS());
+}
+
+void operator delete(void* memory) noexcept { cpptf_allocation_hooks::release(memory); }
+void operator delete[](void* memory) noexcept { cpptf_allocation_hooks::release(memory); }
+void operator delete(void* memory, std::size_t) noexcept { cpptf_allocation_hooks::release(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { cpptf_allocation_hooks::release(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { cpptf_allocation_hooks::release(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { cpptf_allocation_hooks::release(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { cpptf_allocation_hooks::releaseAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { cpptf_allocation_hooks::releaseAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { cpptf_allocation_hooks::releaseAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { cpptf_allocation_hooks::releaseAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { cpptf_allocation_hooks::releaseAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { cpptf_allocation_hooks::releaseAligned(memory); }
+
+#endif
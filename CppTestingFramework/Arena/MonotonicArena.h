@@ -0,0 +1,112 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<new>
+#include<memory>
+#include<type_traits>
+#include<utility>
+#include<algorithm>
+
+// Monotonic (bump pointer) arena.
+// Objects are placed one after another in large chunks that grow geometrically, so a million small
+// objects cost a few dozen chunk allocations and sit next to each other in memory.
+// Nothing is freed individually: release() runs the pending destructors in reverse order and frees
+// every chunk at once.
+class MonotonicArena {
+private:
+    struct Chunk {
+        Chunk* previous;
+        std::size_t capacity;
+        // followed by capacity bytes of storage
+        std::byte* data() { return reinterpret_cast<std::byte*>(this + 1); }
+    };
+
+    struct DestructorNode {
+        void (*destroy)(void* object);
+        void* object;
+        DestructorNode* next;
+    };
+
+    Chunk* current = nullptr;
+    std::size_t used = 0;
+    std::size_t nextChunkSize;
+    std::size_t maxChunkSize;
+    std::size_t chunkCount = 0;
+    DestructorNode* destructors = nullptr;
+
+    void addChunk(std::size_t minimum);
+
+public:
+    explicit MonotonicArena(std::size_t initialChunkSize = 64 * 1024, std::size_t maxChunkSize = 64 * 1024 * 1024)
+        : nextChunkSize(initialChunkSize), maxChunkSize(maxChunkSize) {
+    }
+    ~MonotonicArena() { release(); }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    // Construct a U inside the arena; its destructor runs on release() unless it is trivial
+    template <typename U, typename... Args>
+    U* create(Args&&... args);
+
+    void release();
+
+    std::size_t chunks() const { return chunkCount; }
+};
+
+
+inline void MonotonicArena::addChunk(std::size_t minimum) {
+    std::size_t capacity = std::max(nextChunkSize, minimum + alignof(std::max_align_t));
+    void* memory = ::operator new(sizeof(Chunk) + capacity);
+    Chunk* chunk = new (memory) Chunk{ current, capacity };
+
+    current = chunk;
+    used = 0;
+    ++chunkCount;
+    nextChunkSize = std::min(nextChunkSize * 2, maxChunkSize);
+}
+
+inline void* MonotonicArena::allocate(std::size_t size, std::size_t alignment) {
+    if (current != nullptr) {
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(current->data());
+        std::uintptr_t aligned = (base + used + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        std::size_t end = static_cast<std::size_t>(aligned - base) + size;
+        if (end <= current->capacity) {
+            used = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    addChunk(size + alignment);
+    return allocate(size, alignment);
+}
+
+template <typename U, typename... Args>
+U* MonotonicArena::create(Args&&... args) {
+    void* memory = allocate(sizeof(U), alignof(U));
+    U* object = new (memory) U(std::forward<Args>(args)...);
+
+    if constexpr (!std::is_trivially_destructible_v<U>) {
+        void* nodeMemory = allocate(sizeof(DestructorNode), alignof(DestructorNode));
+        destructors = new (nodeMemory) DestructorNode{ [](void* p) { static_cast<U*>(p)->~U(); }, object, destructors };
+    }
+    return object;
+}
+
+inline void MonotonicArena::release() {
+    // Newest first, like automatic objects
+    for (DestructorNode* node = destructors; node != nullptr; node = node->next) {
+        node->destroy(node->object);
+    }
+    destructors = nullptr;
+
+    while (current != nullptr) {
+        Chunk* previous = current->previous;
+        ::operator delete(current);
+        current = previous;
+    }
+    used = 0;
+    chunkCount = 0;
+}
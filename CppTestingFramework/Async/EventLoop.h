@@ -0,0 +1,493 @@
+#pragma once
+#include<coroutine>
+#include<chrono>
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+#include<deque>
+#include<queue>
+#include<future>
+#include<memory>
+#include<mutex>
+#include<condition_variable>
+#include<exception>
+#include<string>
+#include<string_view>
+#include<utility>
+#include<algorithm>
+#include "../Reporter/Reporter.h"
+#include "../Profiler/TimingRecorder.h"
+
+// C++20 coroutine assertions and the single-threaded event loop that runs them.
+//
+// An async assertion is a coroutine returning AsyncAssertion that co_returns its bool result:
+//
+//     AsyncAssertion fetchTest(UnitTest<int>& test) {
+//         co_await asyncSleep(std::chrono::milliseconds(5));
+//         int value = co_await awaitFuture(std::async(std::launch::async, compute));
+//         co_return test.assertEqual(value, 42);
+//     }
+//
+// Thousands of them can be pending on one EventLoop at once: a suspended assertion is just its coroutine
+// frame plus one entry in a timer heap, a future poll list or an AsyncEvent waiter list. No thread is
+// blocked per assertion. A timeout is one more timer; when it fires first the frame is destroyed and the
+// assertion reported as timed out.
+// Coroutines must only await the awaitables below (or their own awaitables built on EventLoop::schedule,
+// addTimer, addPoll or AsyncEvent), never resume themselves on another thread.
+
+class EventLoop;
+
+class AsyncAssertion {
+public:
+    struct promise_type {
+        bool result = false;
+        std::exception_ptr error;
+
+        AsyncAssertion get_return_object() {
+            return AsyncAssertion(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // Lazy: nothing runs until the loop resumes it the first time
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        // Kept alive after finishing so the loop can read the result, the loop destroys it
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(bool passed) { result = passed; }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    AsyncAssertion(AsyncAssertion&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    AsyncAssertion& operator=(AsyncAssertion&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~AsyncAssertion() {
+        if (handle) handle.destroy();
+    }
+
+    // Ownership of the frame moves to the loop
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle, nullptr); }
+
+private:
+    explicit AsyncAssertion(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Wakeups that may come from other threads. Shared with AsyncEvent so a late set() after the loop is
+// gone only lands in an orphaned queue.
+struct EventLoopMailbox {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::pair<std::size_t, std::coroutine_handle<>>> posted;
+};
+
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TaskId = std::size_t;
+
+    struct Outcome {
+        bool finished = false;
+        bool passed = false;
+        bool timedOut = false;
+        bool cancelled = false;   // dropped unfinished because another assertion timed out (stopOnTimeout)
+        std::chrono::nanoseconds elapsed{ 0 };
+    };
+
+    // How often pending futures are polled while nothing else is due
+    static constexpr std::chrono::microseconds futurePollInterval{ 200 };
+
+    EventLoop() : mailbox(std::make_shared<EventLoopMailbox>()) {}
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Queue an assertion; index and suiteName only label its reports. timeout == 0 waits forever.
+    // test is the test context it is resumed under (see TestContext), empty keeps the one of the spawning thread.
+    TaskId spawn(AsyncAssertion assertion, std::string_view suiteName, std::size_t index, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0),
+        std::string_view test = {});
+
+    // Run until every spawned assertion has finished or timed out
+    void run();
+
+    // The first timeout cancels every assertion still pending (TimeoutOptions::continueAfterTimeout == false)
+    void stopOnTimeout(bool stop) { stopAfterTimeout = stop; }
+
+    const Outcome& outcome(TaskId id) const { return tasks[id].outcome; }
+    std::size_t size() const { return tasks.size(); }
+
+    // Loop and assertion being resumed on this thread, for awaitables
+    static EventLoop* current() { return currentLoop; }
+    static TaskId currentTask() { return currentId; }
+
+    // Scheduling primitives used by the awaitables, loop thread only
+    void schedule(TaskId id, std::coroutine_handle<> handle) { ready.push_back({ id, handle }); }
+    void addTimer(Clock::time_point when, TaskId id, std::coroutine_handle<> handle);
+    void addPoll(TaskId id, std::coroutine_handle<> handle, bool (*isReady)(const void*), const void* state);
+    std::shared_ptr<EventLoopMailbox> sharedMailbox() const { return mailbox; }
+
+private:
+    struct Task {
+        std::coroutine_handle<AsyncAssertion::promise_type> handle;
+        std::string_view suiteName;
+        std::size_t index;
+        std::string_view test;
+        Clock::time_point start;
+        Outcome outcome;
+    };
+    struct Wakeup {
+        TaskId id;
+        std::coroutine_handle<> handle;
+    };
+    struct Timer {
+        Clock::time_point when;
+        TaskId id;
+        std::coroutine_handle<> handle;   // null: the task's timeout
+        bool operator>(const Timer& other) const { return when > other.when; }
+    };
+    struct Poll {
+        TaskId id;
+        std::coroutine_handle<> handle;
+        bool (*isReady)(const void*);
+        const void* state;
+    };
+
+    std::vector<Task> tasks;
+    std::size_t pending = 0;
+    std::deque<Wakeup> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    std::vector<Poll> polls;
+    std::shared_ptr<EventLoopMailbox> mailbox;
+    bool stopAfterTimeout = false;
+
+    inline static thread_local EventLoop* currentLoop = nullptr;
+    inline static thread_local TaskId currentId = 0;
+
+    void resume(TaskId id, std::coroutine_handle<> handle);
+    void finish(TaskId id, bool timedOut);
+    void cancelPending();
+
+    struct Failure {
+        std::size_t index;
+        double elapsedMs;
+        const char* what;
+    };
+    static void describeFailure(std::ostream& os, const void* context);
+};
+
+// Resume after a delay
+struct SleepAwaiter {
+    std::chrono::nanoseconds delay;
+
+    bool await_ready() const noexcept { return delay.count() <= 0; }
+    void await_suspend(std::coroutine_handle<> handle) const {
+        EventLoop::current()->addTimer(EventLoop::Clock::now() + delay, EventLoop::currentTask(), handle);
+    }
+    void await_resume() const noexcept {}
+};
+
+template <typename Rep, typename Period>
+SleepAwaiter asyncSleep(std::chrono::duration<Rep, Period> delay) {
+    return { std::chrono::duration_cast<std::chrono::nanoseconds>(delay) };
+}
+
+// Let the other ready assertions run first
+struct YieldAwaiter {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const {
+        EventLoop::current()->schedule(EventLoop::currentTask(), handle);
+    }
+    void await_resume() const noexcept {}
+};
+
+inline YieldAwaiter asyncYield() {
+    return {};
+}
+
+// Wait for a std::future / std::shared_future without blocking the loop; co_await yields its get()
+template <typename Future>
+class FutureAwaiter {
+private:
+    Future future;
+
+    static bool isReady(const void* state) {
+        return static_cast<const Future*>(state)->wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+public:
+    explicit FutureAwaiter(Future&& future) : future(std::move(future)) {}
+
+    bool await_ready() const { return isReady(&future); }
+    void await_suspend(std::coroutine_handle<> handle) const {
+        EventLoop::current()->addPoll(EventLoop::currentTask(), handle, &FutureAwaiter::isReady, &future);
+    }
+    decltype(auto) await_resume() { return future.get(); }
+};
+
+template <typename U>
+FutureAwaiter<std::future<U>> awaitFuture(std::future<U>&& future) {
+    return FutureAwaiter<std::future<U>>(std::move(future));
+}
+
+template <typename U>
+FutureAwaiter<std::shared_future<U>> awaitFuture(const std::shared_future<U>& future) {
+    return FutureAwaiter<std::shared_future<U>>(std::shared_future<U>(future));
+}
+
+// One-shot event that any thread can set; every assertion awaiting it is resumed on its own loop.
+// This is the cheapest way to bridge callback based async code into a test: no polling at all.
+class AsyncEvent {
+private:
+    struct Waiter {
+        std::weak_ptr<EventLoopMailbox> mailbox;
+        EventLoop::TaskId id;
+        std::coroutine_handle<> handle;
+    };
+
+    std::mutex mutex;
+    bool isSet = false;
+    std::vector<Waiter> waiters;
+
+public:
+    void set();
+    bool ready() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return isSet;
+    }
+
+    struct Awaiter {
+        AsyncEvent& event;
+
+        bool await_ready() { return event.ready(); }
+        bool await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    Awaiter operator co_await() { return { *this }; }
+};
+
+
+inline EventLoop::~EventLoop() {
+    // Frames of assertions that never finished (run() not called or left through an exception)
+    for (Task& task : tasks) {
+        if (task.handle) {
+            task.handle.destroy();
+        }
+    }
+}
+
+inline EventLoop::TaskId EventLoop::spawn(AsyncAssertion assertion, std::string_view suiteName, std::size_t index, std::chrono::nanoseconds timeout,
+    std::string_view test) {
+    const TaskId id = tasks.size();
+    tasks.push_back({ assertion.release(), suiteName, index, test.empty() ? TestContext::current() : test, Clock::now(), {} });
+    ++pending;
+    ready.push_back({ id, tasks[id].handle });
+    if (timeout.count() > 0) {
+        timers.push({ tasks[id].start + timeout, id, nullptr });
+    }
+    return id;
+}
+
+inline void EventLoop::addTimer(Clock::time_point when, TaskId id, std::coroutine_handle<> handle) {
+    timers.push({ when, id, handle });
+}
+
+inline void EventLoop::addPoll(TaskId id, std::coroutine_handle<> handle, bool (*isReady)(const void*), const void* state) {
+    polls.push_back({ id, handle, isReady, state });
+}
+
+inline void EventLoop::resume(TaskId id, std::coroutine_handle<> handle) {
+    if (tasks[id].outcome.finished) {
+        return;  // wakeup for an assertion that already timed out
+    }
+    EventLoop* previousLoop = std::exchange(currentLoop, this);
+    TaskId previousId = std::exchange(currentId, id);
+    {
+        TestContext::Scope context(tasks[id].test);
+        handle.resume();
+    }
+    currentLoop = previousLoop;
+    currentId = previousId;
+
+    if (tasks[id].handle.done()) {
+        finish(id, false);
+    }
+}
+
+inline void EventLoop::finish(TaskId id, bool timedOut) {
+    Task& task = tasks[id];
+    Outcome& outcome = task.outcome;
+    outcome.finished = true;
+    outcome.timedOut = timedOut;
+    outcome.elapsed = Clock::now() - task.start;
+
+    std::exception_ptr error;
+    if (!timedOut) {
+        outcome.passed = task.handle.promise().result;
+        error = task.handle.promise().error;
+    }
+    // Destroying a suspended frame runs the destructors of its locals, like a cancelled task
+    task.handle.destroy();
+    task.handle = nullptr;
+    --pending;
+
+    if (TimingRecorder::getInstance().enabled()) {
+        TimingRecorder& recorder = TimingRecorder::getInstance();
+        const std::int64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(outcome.elapsed).count();
+        recorder.record(task.suiteName.data(), task.index, recorder.now() - elapsedNs, elapsedNs);
+    }
+    if (timedOut && stopAfterTimeout) {
+        cancelPending();
+    }
+
+    if (timedOut || error) {
+        outcome.passed = false;
+        Reporter& reporter = Reporter::current();
+        if (!reporter.wants(false)) {
+            return;
+        }
+        std::string message;
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& exception) {
+                message = std::string("threw: ") + exception.what();
+            }
+            catch (...) {
+                message = "threw a non-std exception";
+            }
+        }
+        Failure failure{ task.index, std::chrono::duration<double, std::milli>(outcome.elapsed).count(), timedOut ? nullptr : message.c_str() };
+        reporter.report({ false, task.suiteName, timedOut ? "timeout" : "exception", &EventLoop::describeFailure, &failure, task.test });
+    }
+}
+
+// Only called from run(), never while a frame is executing, so every pending frame can be destroyed
+inline void EventLoop::cancelPending() {
+    for (Task& task : tasks) {
+        if (task.outcome.finished) {
+            continue;
+        }
+        task.outcome.finished = true;
+        task.outcome.cancelled = true;
+        task.outcome.elapsed = Clock::now() - task.start;
+        task.handle.destroy();
+        task.handle = nullptr;
+        --pending;
+    }
+}
+
+inline void EventLoop::describeFailure(std::ostream& os, const void* context) {
+    const Failure& failure = *static_cast<const Failure*>(context);
+    os << "async assertion #" << failure.index;
+    if (failure.what == nullptr) {
+        os << " timed out after " << failure.elapsedMs << " ms";
+    }
+    else {
+        os << ' ' << failure.what;
+    }
+}
+
+inline void EventLoop::run() {
+    std::vector<std::pair<std::size_t, std::coroutine_handle<>>> posted;
+
+    while (pending > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mailbox->mutex);
+            posted.swap(mailbox->posted);
+        }
+        for (const auto& [id, handle] : posted) {
+            ready.push_back({ id, handle });
+        }
+        posted.clear();
+
+        // Only what is ready now; wakeups scheduled while resuming wait for the next round
+        for (std::size_t count = ready.size(); count > 0 && !ready.empty(); --count) {
+            Wakeup wakeup = ready.front();
+            ready.pop_front();
+            resume(wakeup.id, wakeup.handle);
+        }
+
+        const Clock::time_point now = Clock::now();
+        while (!timers.empty() && timers.top().when <= now) {
+            Timer timer = timers.top();
+            timers.pop();
+            if (tasks[timer.id].outcome.finished) {
+                continue;
+            }
+            if (timer.handle) {
+                ready.push_back({ timer.id, timer.handle });
+            }
+            else {
+                finish(timer.id, true);
+            }
+        }
+
+        for (std::size_t i = 0; i < polls.size();) {
+            const Poll& poll = polls[i];
+            if (tasks[poll.id].outcome.finished) {
+                polls[i] = polls.back();
+                polls.pop_back();
+            }
+            else if (poll.isReady(poll.state)) {
+                ready.push_back({ poll.id, poll.handle });
+                polls[i] = polls.back();
+                polls.pop_back();
+            }
+            else {
+                ++i;
+            }
+        }
+
+        if (!ready.empty() || pending == 0) {
+            continue;
+        }
+
+        // Nothing to do: sleep until the next timer, the next future poll or a post from another thread
+        Clock::time_point wakeAt = Clock::time_point::max();
+        if (!timers.empty()) {
+            wakeAt = timers.top().when;
+        }
+        if (!polls.empty()) {
+            wakeAt = std::min(wakeAt, now + futurePollInterval);
+        }
+        std::unique_lock<std::mutex> lock(mailbox->mutex);
+        if (wakeAt == Clock::time_point::max()) {
+            mailbox->wake.wait(lock, [this]() { return !mailbox->posted.empty(); });
+        }
+        else {
+            mailbox->wake.wait_until(lock, wakeAt, [this]() { return !mailbox->posted.empty(); });
+        }
+    }
+}
+
+inline void AsyncEvent::set() {
+    std::vector<Waiter> woken;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isSet = true;
+        woken.swap(waiters);
+    }
+    for (const Waiter& waiter : woken) {
+        if (std::shared_ptr<EventLoopMailbox> mailbox = waiter.mailbox.lock()) {
+            {
+                std::lock_guard<std::mutex> lock(mailbox->mutex);
+                mailbox->posted.emplace_back(waiter.id, waiter.handle);
+            }
+            mailbox->wake.notify_one();
+        }
+    }
+}
+
+inline bool AsyncEvent::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(event.mutex);
+    if (event.isSet) {
+        return false;  // set between await_ready and here: continue right away
+    }
+    EventLoop* loop = EventLoop::current();
+    event.waiters.push_back({ loop->sharedMailbox(), EventLoop::currentTask(), handle });
+    return true;
+}
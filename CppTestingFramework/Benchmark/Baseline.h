@@ -0,0 +1,213 @@
+#pragma once
+#include<map>
+#include<vector>
+#include<string>
+#include<fstream>
+#include<mutex>
+#include<cmath>
+#include<cstdint>
+#include<cstring>
+#include<algorithm>
+#include<optional>
+
+// Per-benchmark timing samples kept in a compact binary file between runs.
+// Layout (native endianness): "CTFB" u32 version, u32 entryCount,
+// then per entry: u32 nameLength, name bytes, u32 sampleCount, sampleCount doubles (ns per iteration).
+class BaselineStore {
+private:
+    std::map<std::string, std::vector<double>> baselines;
+    std::string path = "perf_baselines.bin";
+    bool loaded = false;
+    bool updateBaselines = false;
+    mutable std::mutex storeMutex;
+
+    static constexpr char magic[4] = { 'C', 'T', 'F', 'B' };
+    static constexpr std::uint32_t version = 1;
+
+    BaselineStore() = default;
+    BaselineStore(const BaselineStore&) = delete;
+    BaselineStore& operator=(const BaselineStore&) = delete;
+
+    void loadLocked();
+    void saveLocked() const;
+
+public:
+    static BaselineStore& getInstance();
+
+    // Where baselines are read from and written to; switching paths drops what was loaded
+    void setPath(const std::string& newPath);
+    const std::string& getPath() const { return path; }
+
+    // When set, every regression check overwrites the stored baseline with its fresh samples
+    void setUpdateBaselines(bool enabled);
+    bool updatesBaselines() const;
+
+    std::optional<std::vector<double>> find(const std::string& name);
+    void store(const std::string& name, const std::vector<double>& samples);
+};
+
+// One-sided Mann-Whitney U test: probability of seeing samples at least this much slower than
+// baseline if both came from the same distribution. Robust to outliers and non-normal timing noise.
+double slowerThanBaselinePValue(const std::vector<double>& current, const std::vector<double>& baseline);
+
+
+inline BaselineStore& BaselineStore::getInstance() {
+    static BaselineStore store;
+    return store;
+}
+
+inline void BaselineStore::setPath(const std::string& newPath) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    path = newPath;
+    baselines.clear();
+    loaded = false;
+}
+
+inline void BaselineStore::setUpdateBaselines(bool enabled) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    updateBaselines = enabled;
+}
+
+inline bool BaselineStore::updatesBaselines() const {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return updateBaselines;
+}
+
+inline std::optional<std::vector<double>> BaselineStore::find(const std::string& name) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    loadLocked();
+    auto it = baselines.find(name);
+    if (it == baselines.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+inline void BaselineStore::store(const std::string& name, const std::vector<double>& samples) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    loadLocked();
+    baselines[name] = samples;
+    saveLocked();
+}
+
+inline void BaselineStore::loadLocked() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return;  // no baselines yet
+    }
+    // Lengths read from the file are checked against what is left of it before anything is allocated
+    std::uint64_t remaining = static_cast<std::uint64_t>(std::max<std::streamoff>(in.tellg(), 0));
+    in.seekg(0);
+
+    char fileMagic[4] = {};
+    std::uint32_t fileVersion = 0;
+    std::uint32_t entryCount = 0;
+    in.read(fileMagic, sizeof(fileMagic));
+    in.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
+    in.read(reinterpret_cast<char*>(&entryCount), sizeof(entryCount));
+    constexpr std::uint64_t headerSize = sizeof(fileMagic) + sizeof(fileVersion) + sizeof(entryCount);
+    if (!in || std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || fileVersion != version || remaining < headerSize) {
+        return;  // unknown or damaged file: start over, it gets rewritten on the next store()
+    }
+    remaining -= headerSize;
+
+    // Truncated or corrupt: drop the whole file rather than keep a partial or absurd baseline
+    auto reject = [this]() { baselines.clear(); };
+    constexpr std::uint64_t lengthSize = sizeof(std::uint32_t);
+    if (entryCount > remaining / (2 * lengthSize)) {
+        return reject();
+    }
+
+    for (std::uint32_t entry = 0; entry < entryCount; ++entry) {
+        std::uint32_t nameLength = 0;
+        in.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        if (!in || remaining < lengthSize || nameLength > remaining - lengthSize) {
+            return reject();
+        }
+        remaining -= lengthSize + nameLength;
+        std::string name(nameLength, '\0');
+        in.read(name.data(), nameLength);
+
+        std::uint32_t sampleCount = 0;
+        in.read(reinterpret_cast<char*>(&sampleCount), sizeof(sampleCount));
+        if (!in || remaining < lengthSize || sampleCount > (remaining - lengthSize) / sizeof(double)) {
+            return reject();
+        }
+        remaining -= lengthSize + std::uint64_t{ sampleCount } * sizeof(double);
+        std::vector<double> samples(sampleCount);
+        in.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(sampleCount * sizeof(double)));
+
+        if (!in) {
+            return reject();
+        }
+        baselines[name] = std::move(samples);
+    }
+}
+
+inline void BaselineStore::saveLocked() const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const std::uint32_t entryCount = static_cast<std::uint32_t>(baselines.size());
+
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&entryCount), sizeof(entryCount));
+
+    for (const auto& [name, samples] : baselines) {
+        const std::uint32_t nameLength = static_cast<std::uint32_t>(name.size());
+        const std::uint32_t sampleCount = static_cast<std::uint32_t>(samples.size());
+        out.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+        out.write(name.data(), nameLength);
+        out.write(reinterpret_cast<const char*>(&sampleCount), sizeof(sampleCount));
+        out.write(reinterpret_cast<const char*>(samples.data()), static_cast<std::streamsize>(sampleCount * sizeof(double)));
+    }
+}
+
+inline double slowerThanBaselinePValue(const std::vector<double>& current, const std::vector<double>& baseline) {
+    const std::size_t n1 = current.size();
+    const std::size_t n2 = baseline.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1.0;
+    }
+
+    // Rank the pooled samples, ties get the average of their ranks
+    std::vector<std::pair<double, bool>> pooled;  // value, belongs to current
+    pooled.reserve(n1 + n2);
+    for (double value : current) pooled.emplace_back(value, true);
+    for (double value : baseline) pooled.emplace_back(value, false);
+    std::sort(pooled.begin(), pooled.end());
+
+    const double n = static_cast<double>(n1 + n2);
+    double currentRankSum = 0;
+    double tieCorrection = 0;
+    for (std::size_t i = 0; i < pooled.size();) {
+        std::size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+            ++j;
+        }
+        const double averageRank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+        for (std::size_t k = i; k < j; ++k) {
+            if (pooled[k].second) {
+                currentRankSum += averageRank;
+            }
+        }
+        const double ties = static_cast<double>(j - i);
+        tieCorrection += ties * ties * ties - ties;
+        i = j;
+    }
+
+    const double u = currentRankSum - static_cast<double>(n1) * (static_cast<double>(n1) + 1) / 2.0;
+    const double mean = static_cast<double>(n1) * static_cast<double>(n2) / 2.0;
+    const double variance = static_cast<double>(n1) * static_cast<double>(n2) / 12.0 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (variance <= 0) {
+        return 1.0;
+    }
+
+    // Normal approximation with continuity correction
+    const double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
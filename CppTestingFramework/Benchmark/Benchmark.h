@@ -0,0 +1,216 @@
+#pragma once
+#include<vector>
+#include<string>
+#include<chrono>
+#include<cmath>
+#include<cstdint>
+#include<algorithm>
+#include<numeric>
+#include<ostream>
+#include<type_traits>
+#include<utility>
+#include "../FunctionWrapper/FunctionWrapper.h"
+
+#if defined(_MSC_VER)
+#include<intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include<x86intrin.h>
+#endif
+
+// Keep the compiler from proving a value unused and deleting the code that produced it
+template <typename U>
+inline void doNotOptimize(U const& value) {
+#if defined(_MSC_VER)
+    static_cast<void>(*reinterpret_cast<char const volatile*>(&value));
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+template <typename U>
+inline void doNotOptimize(U& value) {
+#if defined(_MSC_VER)
+    static_cast<void>(*reinterpret_cast<char volatile*>(&value));
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : "+r,m"(value) : : "memory");
+#endif
+}
+
+// Force pending memory writes to be considered observable
+inline void clobberMemory() {
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+// Raw CPU timestamp counter (TSC on x86, virtual counter on AArch64), steady_clock ticks elsewhere
+inline std::uint64_t readCycleCounter() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_lfence();
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    return __rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t ticks;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// min/median/p99/mean/stddev of a set of per-iteration timings
+struct SampleStats {
+    double min = 0;
+    double median = 0;
+    double p99 = 0;
+    double mean = 0;
+    double stddev = 0;
+
+    // Sorts samples in place
+    static SampleStats compute(std::vector<double>& samples);
+};
+
+struct BenchmarkOptions {
+    std::chrono::nanoseconds warmupTime = std::chrono::milliseconds(50);
+    std::chrono::nanoseconds minSampleTime = std::chrono::milliseconds(2);  // iteration count is calibrated to this
+    std::size_t sampleCount = 50;
+    std::size_t maxIterations = std::size_t(1) << 30;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::size_t iterationsPerSample = 0;
+    std::size_t sampleCount = 0;
+    SampleStats nanoseconds;  // per iteration
+    SampleStats cycles;       // per iteration, in readCycleCounter() ticks
+    std::vector<double> samples;  // sorted per-iteration nanoseconds of every sample
+};
+
+std::ostream& operator<<(std::ostream& os, const BenchmarkResult& result);
+
+// Microbenchmark harness: warmup, iteration count calibration, then sampleCount timed batches.
+// Every sample times a whole batch of calls and divides, so clock overhead stays out of the result.
+class Benchmark {
+private:
+    BenchmarkOptions options;
+
+    template <typename Func>
+    static void runBatch(Func& func, std::size_t iterations);
+
+public:
+    explicit Benchmark(const BenchmarkOptions& options = {}) : options(options) {}
+
+    // Any callable; a non-void return value is passed through doNotOptimize
+    template <typename Func>
+    BenchmarkResult run(const std::string& name, Func&& func) const;
+
+    // Reruns wrapper.call() with its stored arguments
+    template <typename... Args>
+    BenchmarkResult run(const std::string& name, FunctionWrapper<Args...>& wrapper) const;
+};
+
+
+inline SampleStats SampleStats::compute(std::vector<double>& samples) {
+    SampleStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const std::size_t count = samples.size();
+
+    stats.min = samples.front();
+    stats.median = (count % 2 == 1) ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+    std::size_t p99Index = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(count))) - 1;
+    stats.p99 = samples[std::min(p99Index, count - 1)];
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(count);
+
+    double squares = 0;
+    for (double sample : samples) {
+        squares += (sample - stats.mean) * (sample - stats.mean);
+    }
+    stats.stddev = count > 1 ? std::sqrt(squares / static_cast<double>(count - 1)) : 0.0;
+    return stats;
+}
+
+template <typename Func>
+void Benchmark::runBatch(Func& func, std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+        if constexpr (std::is_void_v<std::invoke_result_t<Func&>>) {
+            func();
+        }
+        else {
+            auto result = func();
+            doNotOptimize(result);
+        }
+        clobberMemory();
+    }
+}
+
+template <typename Func>
+BenchmarkResult Benchmark::run(const std::string& name, Func&& func) const {
+    using Clock = std::chrono::steady_clock;
+
+    // Warmup: caches, branch predictors, lazy initialisation, CPU frequency
+    const auto warmupEnd = Clock::now() + options.warmupTime;
+    do {
+        runBatch(func, 1);
+    } while (Clock::now() < warmupEnd);
+
+    // Calibration: double the batch until one batch takes at least minSampleTime
+    std::size_t iterations = 1;
+    while (iterations < options.maxIterations) {
+        const auto start = Clock::now();
+        runBatch(func, iterations);
+        if (Clock::now() - start >= options.minSampleTime) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> nanoseconds;
+    std::vector<double> cycles;
+    nanoseconds.reserve(options.sampleCount);
+    cycles.reserve(options.sampleCount);
+
+    for (std::size_t sample = 0; sample < options.sampleCount; ++sample) {
+        const auto start = Clock::now();
+        const std::uint64_t startCycles = readCycleCounter();
+        runBatch(func, iterations);
+        const std::uint64_t endCycles = readCycleCounter();
+        const auto end = Clock::now();
+
+        nanoseconds.push_back(std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations));
+        cycles.push_back(static_cast<double>(endCycles - startCycles) / static_cast<double>(iterations));
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterationsPerSample = iterations;
+    result.sampleCount = options.sampleCount;
+    result.nanoseconds = SampleStats::compute(nanoseconds);
+    result.cycles = SampleStats::compute(cycles);
+    result.samples = std::move(nanoseconds);
+    return result;
+}
+
+template <typename... Args>
+BenchmarkResult Benchmark::run(const std::string& name, FunctionWrapper<Args...>& wrapper) const {
+    return run(name, [&wrapper]() { wrapper.call(); });
+}
+
+inline std::ostream& operator<<(std::ostream& os, const BenchmarkResult& result) {
+    return os << "[BENCH] " << result.name
+        << ": min " << result.nanoseconds.min << " ns"
+        << ", median " << result.nanoseconds.median << " ns"
+        << ", p99 " << result.nanoseconds.p99 << " ns"
+        << ", stddev " << result.nanoseconds.stddev << " ns"
+        << ", median " << result.cycles.median << " cycles"
+        << " (" << result.sampleCount << " x " << result.iterationsPerSample << " iterations)";
+}
@@ -2,7 +2,14 @@
 //
 
 #include "CppTestingFramework.h"
+#define CPPTF_TRACK_ALLOCATIONS  // this TU provides the allocation tracking operator new/delete
+#include "./AllocationTracker/AllocationTracker.h"
 #include "./UnitTest/UnitTest.h"
+#include "./Reporter/JUnitReporter.h"
+#include "./Reporter/JsonLinesReporter.h"
+#include "./Reporter/MultiReporter.h"
+#include "./Benchmark/Benchmark.h"
+#include "./Registry/IsolatedRunner.h"
 
 
 #include <vector>
@@ -13,7 +20,14 @@
 #include <map>
 #include <unordered_map>
 #include <array>
+#include <limits>
 #include <string>
+#include <memory>
+#include <csignal>
+#include <thread>
+#include <future>
+#include <fstream>
+#include <filesystem>
 
 
 using namespace std;
@@ -127,15 +141,15 @@ public:
             return unittest.assertEqual(*a, *b);
             }, &myTestClass1, &myTestClass2);
         
-        unittest.addAssertion(
-            &UnitTest<TestClass>::assertEqual,
-            new TestClass(3), 
-            new TestClass(3)
-        );
-
-
         // Run the assertions
         unittest.runTests();  // Calling the base class method
+
+        // Statically typed path: arguments are owned, so nothing leaks like `new TestClass(3)` did
+        auto staticAssertions = unittest.makeStaticAssertions(
+            bindAssertion(&UnitTest<TestClass>::assertEqual, std::make_unique<TestClass>(3), std::make_unique<TestClass>(3)),
+            bindAssertion([&unittest](const TestClass* a, const TestClass* b) { return unittest.assertNotEqual(*a, *b); },
+                &myTestClass1, &myTestClass2));  // Fail
+        staticAssertions.run();
     }
 
 };
@@ -283,25 +297,33 @@ void assertInTest() {
     intTest.assertIn(1, us, "Unordered Set Test");
     intTest.assertIn(10, us, "Unordered Set Test");
 
-    //std::cout << "\n===== Testing std::map<int, std::string> =====" << std::endl;
-    //std::map<int, std::string> mp = { {1, "one"}, {2, "two"}, {3, "three"} };
-    //intTest.assertIn(2, mp, "Map Test"); // Checking key existence
-    //intTest.assertIn(10, mp, "Map Test");
-
-    //std::cout << "\n===== Testing std::unordered_map<int, std::string> =====" << std::endl;
-    //std::unordered_map<int, std::string> ump = { {1, "one"}, {2, "two"}, {3, "three"} };
-    //intTest.assertIn(3, ump, "Unordered Map Test");
-    //intTest.assertIn(10, ump, "Unordered Map Test");
-
-    //std::cout << "\n===== Testing std::string =====" << std::endl;
-    //std::string str = "hello";
-    //stringTest.assertIn(std::string(1, 'e'), str, "String Test");
-    //stringTest.assertIn(std::string(1, 'z'), str, "String Test");
-
-    //std::cout << "\n===== Testing std::array<int, 5> =====" << std::endl;
-    //std::array<int, 5> arr = { 1, 2, 3, 4, 5 };
-    //intTest.assertIn(3, arr, "Array Test");
-    //intTest.assertIn(10, arr, "Array Test");
+    std::cout << "\n===== Testing std::map<int, std::string> =====" << std::endl;
+    std::map<int, std::string> mp = { {1, "one"}, {2, "two"}, {3, "three"} };
+    intTest.assertIn(2, mp, "Map Test"); // Checking key existence
+    intTest.assertIn(10, mp, "Map Test");
+
+    std::cout << "\n===== Testing std::unordered_map<int, std::string> =====" << std::endl;
+    std::unordered_map<int, std::string> ump = { {1, "one"}, {2, "two"}, {3, "three"} };
+    intTest.assertIn(3, ump, "Unordered Map Test");
+    intTest.assertIn(10, ump, "Unordered Map Test");
+
+    std::cout << "\n===== Testing std::string =====" << std::endl;
+    std::string str = "hello";
+    stringTest.assertIn(std::string(1, 'e'), str, "String Test");
+    stringTest.assertIn(std::string(1, 'z'), str, "String Test");
+
+    std::cout << "\n===== Testing std::array<int, 5> =====" << std::endl;
+    std::array<int, 5> arr = { 1, 2, 3, 4, 5 };
+    intTest.assertIn(3, arr, "Array Test");
+    intTest.assertIn(10, arr, "Array Test");
+
+    std::cout << "\n===== Testing std::vector<int> with 4M elements (SIMD scan) =====" << std::endl;
+    std::vector<int> big(4'000'000);
+    for (std::size_t i = 0; i < big.size(); ++i) {
+        big[i] = static_cast<int>(i);
+    }
+    intTest.assertIn(3'999'999, big, "Big Vector Test");
+    intTest.assertNotIn(-1, big, "Big Vector Test");
 }
 
 void testAssertInstance() {
@@ -317,10 +339,610 @@ void testAssertInstance() {
 
 }
 
+void parallelRunTest() {
+    UnitTest<long>& longTest = UnitTest<long>::getInstance();
+
+    std::cout << "\n===== Testing runTestsParallel =====" << std::endl;
+    for (long i = 0; i < 8; ++i) {
+        longTest.addAssertion([&longTest, i]() { return longTest.assertEqual(i * i, i * i); });
+    }
+    longTest.addAssertion([&longTest]() { return longTest.assertEqual(1, 2); });  // Fail
+    longTest.addSerialAssertion([&longTest]() { return longTest.assertNotEqual(1, 2); });
+
+    TestSummary summary = longTest.runTestsParallel(4);
+    std::cout << "Parallel run: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+}
+
+void registryRunTest() {
+    UnitTest<int>& intTest = UnitTest<int>::getInstance();
+    UnitTest<std::string>& stringTest = UnitTest<std::string>::getInstance();
+
+    std::cout << "\n===== Testing TestRegistry::runAll =====" << std::endl;
+    // TestClass::runTests registered pointers to its locals, those entries are dangling by now
+    TestRegistry::getInstance().clear();
+
+    intTest.addAssertion([&intTest]() { return intTest.assertEqual(3, 3); });
+    intTest.addAssertion([&intTest]() { return intTest.assertNotEqual(3, 3); });  // Fail
+    stringTest.addAssertion([&stringTest]() { return stringTest.assertEqual("abc", "abc"); });
+    stringTest.addSerialAssertion([&stringTest]() { return stringTest.assertNotEqual("abc", "abd"); });
+
+    // One pass over the assertions of every UnitTest<T>
+    TestSummary summary = TestRegistry::getInstance().runAll();
+    std::cout << "Registry run: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+
+    TestRegistry::getInstance().clear();
+}
+
+void quietReporterTest() {
+    UnitTest<int>& intTest = UnitTest<int>::getInstance();
+    ConsoleReporter quietReporter(std::cout, true);
+    Reporter::setCurrent(&quietReporter);
+
+    std::cout << "\n===== Testing quiet ConsoleReporter (failures only) =====" << std::endl;
+    for (int i = 0; i < 1000; ++i) {
+        intTest.assertEqual(i, i);  // Pass, never formatted
+    }
+    intTest.assertEqual(1, 2);  // Fail
+
+    Reporter::setCurrent(nullptr);
+}
+
+void structuredReporterTest() {
+    UnitTest<std::string>& stringTest = UnitTest<std::string>::getInstance();
+
+    std::cout << "\n===== Testing JUnitReporter + JsonLinesReporter =====" << std::endl;
+    {
+        JUnitReporter junit(std::cout);
+        JsonLinesReporter json(std::cout);
+        MultiReporter both{ &junit, &json };
+        Reporter::setCurrent(&both);
+
+        TestRegistry::getInstance().clear();
+        stringTest.addAssertion([&stringTest]() { return stringTest.assertEqual("<a&b>", "<a&b>"); });
+        stringTest.addAssertion([&stringTest]() { return stringTest.assertEqual("say \"hi\"", "bye"); });  // Fail
+        RegistryRunOptions options;
+        options.workerCount = 1;
+        TestRegistry::getInstance().runAll(options);
+
+        Reporter::setCurrent(nullptr);
+    }
+    TestRegistry::getInstance().clear();
+}
+
+void benchmarkTest() {
+    std::cout << "\n===== Testing Benchmark =====" << std::endl;
+
+    std::vector<int> numbers(1024, 3);
+    FunctionWrapper<const std::vector<int>*> sumWrapper([](const std::vector<int>* v) {
+        int sum = 0;
+        for (int n : *v) {
+            sum += n;
+        }
+        doNotOptimize(sum);
+        }, &numbers);
+
+    BenchmarkOptions options;
+    options.warmupTime = std::chrono::milliseconds(10);
+    options.minSampleTime = std::chrono::microseconds(200);
+    options.sampleCount = 20;
+
+    Benchmark bench(options);
+    std::cout << bench.run("sum of 1024 ints", sumWrapper) << std::endl;
+
+    UnitTest<int>& perfTest = UnitTest<int>::getInstance();
+    perfTest.assertFasterThan(sumWrapper, std::chrono::milliseconds(1), "", options);
+    perfTest.assertNoRegression("sum of 1024 ints", sumWrapper, 0.50, "", options);  // First run records the baseline
+}
+
+void allocationTest() {
+    UnitTest<int>& intTest = UnitTest<int>::getInstance();
+
+    std::cout << "\n===== Testing assertNoAllocations / assertMaxAllocations =====" << std::endl;
+    std::vector<int> reserved;
+    reserved.reserve(64);
+
+    intTest.assertNoAllocations([&reserved]() {
+        for (int i = 0; i < 64; ++i) {
+            reserved.push_back(i);
+        }
+        });
+    intTest.assertMaxAllocations([]() {
+        std::vector<int> growing;
+        for (int i = 0; i < 1000; ++i) {
+            growing.push_back(i);
+        }
+        std::unique_ptr<int> single = std::make_unique<int>(42);
+        }, 4);  // Fail, the vector reallocates ~11 times; both call sites are listed
+}
+
+void arenaAssertionTest() {
+    UnitTest<std::size_t>& sizeTest = UnitTest<std::size_t>::getInstance();
+    ConsoleReporter quietReporter(std::cout, true);
+    Reporter::setCurrent(&quietReporter);
+
+    std::cout << "\n===== Testing addArenaAssertion (100000 assertions) =====" << std::endl;
+    sizeTest.reserveArenaAssertions(100000);
+    {
+        AllocationScope scope;
+        for (std::size_t i = 0; i < 100000; ++i) {
+            sizeTest.addArenaAssertion([&sizeTest](std::size_t value) { return sizeTest.assertEqual(value % 7, value % 7); }, i);
+        }
+        std::cout << "Registration allocations (arena + registry table): " << scope.counters().allocations << std::endl;
+    }
+
+    TestSummary summary = sizeTest.runTests();
+    std::cout << "Arena run: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+
+    sizeTest.releaseArenaAssertions();
+    Reporter::setCurrent(nullptr);
+}
+
+void rangeAssertionTest() {
+    UnitTest<int>& intTest = UnitTest<int>::getInstance();
+    UnitTest<float>& floatTest = UnitTest<float>::getInstance();
+
+    std::cout << "\n===== Testing assertRangeEqual / assertAllEqual / assertAllNear (10M elements) =====" << std::endl;
+    std::vector<int> frame(10'000'000, 7);
+    std::vector<int> decoded = frame;
+    intTest.assertRangeEqual(frame, decoded);
+    decoded[42] = 8;
+    decoded[9'999'999] = 0;
+    intTest.assertRangeEqual(frame, decoded);  // Fail, 2 mismatches
+    intTest.assertAllEqual(frame, 7);
+
+    std::vector<float> output(10'000'000, 1.0f);
+    std::vector<float> reference(10'000'000, 1.0f + 1e-7f);
+    floatTest.assertAllNear(output, reference, FloatTolerance::ulpsOf(4));
+    floatTest.assertAllNear(output, reference, FloatTolerance::absoluteOf(1e-9), "", 3);  // Fail, first 3 shown
+}
+
 void printHellow() {
     std::cout << "Hellow" << std::endl;
 }
 
+void isolatedRunTest() {
+    UnitTest<int>& intTest = UnitTest<int>::getInstance();
+
+    std::cout << "\n===== Testing IsolatedRunner (forked workers) =====" << std::endl;
+    TestRegistry::getInstance().clear();
+
+    for (int i = 0; i < 8; ++i) {
+        intTest.addAssertion([&intTest, i]() { return intTest.assertEqual(i, i); });
+    }
+    intTest.addAssertion([&intTest]() { return intTest.assertEqual(1, 2); });  // Fail
+#ifdef CPPTF_HAS_FORK
+    // Only survivable in a separate process
+    intTest.addAssertion([]() { std::raise(SIGSEGV); return true; });                                      // Crash
+    intTest.addAssertion([]() { std::this_thread::sleep_for(std::chrono::seconds(30)); return true; });  // Timeout
+#endif
+    intTest.addSerialAssertion([&intTest]() { return intTest.assertNotEqual(1, 2); });
+
+    IsolatedRunOptions options;
+    options.workerCount = 4;
+    options.timeout = std::chrono::milliseconds(500);
+
+    IsolatedRunner runner;
+    TestSummary summary = runner.run(options);
+    std::cout << "Isolated run: " << summary.passed << " passed, " << summary.failed << " failed ("
+        << runner.crashes() << " crashed, " << runner.timeouts() << " timed out)" << std::endl;
+
+    TestRegistry::getInstance().clear();
+}
+
+void timeoutTest() {
+    UnitTest<short>& shortTest = UnitTest<short>::getInstance();
+
+    std::cout << "\n===== Testing assertion / suite timeouts =====" << std::endl;
+    shortTest.addAssertion([&shortTest]() { return shortTest.assertEqual(1, 1); });
+    shortTest.addAssertion([&shortTest]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));  // Fail: over the 50 ms limit
+        return shortTest.assertEqual(2, 2);
+        });
+    shortTest.addAssertion([&shortTest]() { return shortTest.assertEqual(3, 3); });
+
+    TimeoutOptions options;
+    options.assertionTimeout = std::chrono::milliseconds(50);
+    options.hangLimit = std::chrono::seconds(10);
+    shortTest.setTimeouts(options);
+    TestSummary summary = shortTest.runTests();
+    std::cout << "Timed run: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+
+    // Stop at the first timeout, the third assertion is not run
+    options.continueAfterTimeout = false;
+    shortTest.setTimeouts(options);
+    summary = shortTest.runTests();
+    std::cout << "Timed run, stop on timeout: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+
+    shortTest.setTimeouts({});
+    TestRegistry::getInstance().clear();
+}
+
+void timingReportTest() {
+    UnitTest<unsigned>& unsignedTest = UnitTest<unsigned>::getInstance();
+
+    std::cout << "\n===== Testing per-assertion timings =====" << std::endl;
+    for (unsigned i = 0; i < 200; ++i) {
+        unsignedTest.addAssertion([&unsignedTest, i]() {
+            // A few deliberately slow ones so the report has something to show
+            if (i % 50 == 7) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2 + i / 50));
+            }
+            return unsignedTest.assertEqual(i, i);
+            });
+    }
+
+    ConsoleReporter quietReporter(std::cout, true);
+    Reporter::setCurrent(&quietReporter);
+
+    TimingOptions options;
+    options.slowest = 5;
+    TimingRecorder::getInstance().enable(options);
+    unsignedTest.runTestsParallel(4);
+    if (TimingRecorder::getInstance().writeChromeTrace("assertion_trace.json")) {
+        std::cout << "Trace written to assertion_trace.json (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+    }
+    TimingRecorder::getInstance().disable();
+
+    Reporter::setCurrent(nullptr);
+    TestRegistry::getInstance().clear();
+}
+
+void filterTest() {
+    UnitTest<int>& intTest = UnitTest<int>::getInstance();
+    UnitTest<std::string>& stringTest = UnitTest<std::string>::getInstance();
+
+    std::cout << "\n===== Testing filters and rerun of failures =====" << std::endl;
+    TestRegistry& registry = TestRegistry::getInstance();
+    registry.clear();
+
+    intTest.addNamedAssertion("addition", "fast", [&intTest]() { return intTest.assertEqual(1 + 1, 2); });
+    intTest.addNamedAssertion("subtraction", "fast", [&intTest]() { return intTest.assertEqual(3 - 1, 1); });  // Fail
+    intTest.addNamedAssertion("bigLoop", "slow", [&intTest]() { return intTest.assertEqual(1000 * 1000, 1000000); });
+    stringTest.addNamedAssertion("concat", "fast,strings", [&stringTest]() { return stringTest.assertEqual(std::string("a") + "b", "ab"); });
+
+    RegistryRunOptions options;
+    options.workerCount = 1;
+    options.stateFile = RunState::defaultPath;
+
+    std::cout << "-- only [fast], without *sub*" << std::endl;
+    options.filter = TestFilter::parse("[fast],-*sub*");
+    registry.runAll(options);
+
+    std::cout << "-- full run, failures go to " << RunState::defaultPath << std::endl;
+    options.filter = {};
+    registry.runAll(options);
+
+    std::cout << "-- rerun of the last failures only" << std::endl;
+    options.onlyFailed = true;
+    TestSummary summary = registry.runAll(options);
+    std::cout << "Rerun: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+
+    registry.clear();
+}
+
+void asyncAssertionTest() {
+    UnitTest<long long>& asyncTest = UnitTest<long long>::getInstance();
+
+    std::cout << "\n===== Testing coroutine assertions on the event loop =====" << std::endl;
+
+    // 2000 assertions sleeping 20 ms each, all pending at once on one thread
+    for (long long i = 0; i < 2000; ++i) {
+        asyncTest.addAsyncAssertion([&asyncTest, i]() -> AsyncAssertion {
+            co_await asyncSleep(std::chrono::milliseconds(20));
+            co_return asyncTest.assertEqual(i, i);
+            });
+    }
+    asyncTest.addAsyncAssertion([&asyncTest]() -> AsyncAssertion {
+        long long value = co_await awaitFuture(std::async(std::launch::async, []() { return 6LL * 7; }));
+        co_return asyncTest.assertEqual(value, 42);
+        });
+
+    AsyncEvent event;
+    asyncTest.addAsyncAssertion([&asyncTest, &event]() -> AsyncAssertion {
+        co_await event;
+        co_return asyncTest.assertTrue(1);
+        });
+    std::thread setter([&event]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        event.set();
+        });
+
+    asyncTest.addAsyncAssertion([&asyncTest]() -> AsyncAssertion {
+        co_await asyncSleep(std::chrono::seconds(10));  // Fail: timed out by the loop
+        co_return asyncTest.assertTrue(1);
+        });
+
+    TimeoutOptions options;
+    options.assertionTimeout = std::chrono::milliseconds(200);
+    asyncTest.setTimeouts(options);
+
+    ConsoleReporter quietReporter(std::cout, true);
+    Reporter::setCurrent(&quietReporter);
+    auto start = std::chrono::steady_clock::now();
+    TestSummary summary = asyncTest.runTests();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Reporter::setCurrent(nullptr);
+    setter.join();
+
+    std::cout << "Async run: " << summary.passed << " passed, " << summary.failed << " failed in " << elapsed.count() << " ms" << std::endl;
+    asyncTest.setTimeouts({});
+    TestRegistry::getInstance().clear();
+}
+
+void parameterizedTest() {
+    UnitTest<unsigned long>& paramTest = UnitTest<unsigned long>::getInstance();
+
+    std::cout << "\n===== Testing parameterized assertions from lazy generators =====" << std::endl;
+
+    // 1'000'000 cases from a range: one generator and one lambda, cases are built while their batch runs
+    paramTest.addParameterized(range(0UL, 1000000UL), [&paramTest](unsigned long i) {
+        return paramTest.assertEqual(i * 2 / 2, i);
+        }, 4096);
+
+    // Every (a, b) pair of two ranges, unpacked into two arguments
+    paramTest.addParameterized(cartesian(range(0UL, 100UL), values({ 1UL, 3UL, 7UL })), [&paramTest](unsigned long a, unsigned long b) {
+        return paramTest.assertEqual((a + b) - b, a);
+        });
+
+    // Rows of a CSV fixture, the last one is wrong on purpose
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string csvPath = (directory / "cpptf_parameterized.csv").string();
+    {
+        std::ofstream csv(csvPath);
+        csv << "a,b,sum\n1,2,3\n10,20,30\n7,8,16\n";
+    }
+    paramTest.addParameterized(csvRows<unsigned long, unsigned long, unsigned long>(csvPath), [&paramTest](unsigned long a, unsigned long b, unsigned long sum) {
+        return paramTest.assertEqual(a + b, sum);  // Fail for 7,8,16
+        });
+
+    // Fixed size records of a binary fixture
+    struct Record {
+        unsigned long value;
+        unsigned long square;
+    };
+    const std::string binaryPath = (directory / "cpptf_parameterized.bin").string();
+    {
+        std::ofstream binary(binaryPath, std::ios::binary);
+        for (unsigned long i = 0; i < 1000; ++i) {
+            Record record{ i, i * i };
+            binary.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+    }
+    paramTest.addParameterized(binaryRecords<Record>(binaryPath), [&paramTest](const Record& record) {
+        return paramTest.assertEqual(record.value * record.value, record.square);
+        });
+
+    std::cout << paramTest.parameterizedCaseCount() << " cases" << std::endl;
+
+    ConsoleReporter quietReporter(std::cout, true);
+    Reporter::setCurrent(&quietReporter);
+    auto start = std::chrono::steady_clock::now();
+    TestSummary summary = paramTest.runTestsParallel();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Reporter::setCurrent(nullptr);
+
+    std::cout << "Parameterized run: " << summary.passed << " passed, " << summary.failed << " failed in " << elapsed.count() << " ms" << std::endl;
+    TestRegistry::getInstance().clear();
+}
+
+void propertyTest() {
+    UnitTest<int>& intProperty = UnitTest<int>::getInstance();
+    UnitTest<std::vector<int>>& vectorProperty = UnitTest<std::vector<int>>::getInstance();
+
+    std::cout << "\n===== Testing property-based assertions =====" << std::endl;
+
+    // 10^7 generated ints across all cores
+    PropertyOptions many;
+    many.cases = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    intProperty.assertProperty([](int x) { return (x ^ x) == 0 && (x & x) == x; }, many, {}, "xorSelf");
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << many.cases << " cases in " << elapsed.count() << " ms" << std::endl;
+
+    intProperty.assertProperty([](int x) { return x < 1000; });  // Fail: shrinks to 1000
+    intProperty.assertProperty([](int x) { return -static_cast<long long>(x) <= std::numeric_limits<int>::max(); });  // Fail: -x does not fit for INT_MIN
+
+    // No vector holds the same value twice: shrinks to two equal elements
+    auto distinct = [](const std::vector<int>& v) {
+        std::unordered_set<int> seen(v.begin(), v.end());
+        return seen.size() == v.size();
+    };
+    PropertyOptions fixedSeed;
+    fixedSeed.seed = 0x5eed;
+    vectorProperty.assertProperty(distinct, fixedSeed);  // Fail
+
+    // The failing case replays alone from the seed and case index of the report
+    PropertyResult<std::vector<int>> first = checkProperty<std::vector<int>>(distinct, fixedSeed);
+    PropertyOptions replay = fixedSeed;
+    replay.replayCase = first.failingCase;
+    PropertyResult<std::vector<int>> again = checkProperty<std::vector<int>>(distinct, replay);
+    std::cout << "Replayed case #" << first.failingCase << ": " << (*again.original == *first.original ? "same input" : "different input") << std::endl;
+}
+
+// Expensive suite fixture: built once per run, whatever the number of assertions or workers
+struct Dataset {
+    static inline std::atomic<int> builds{ 0 };
+    std::vector<double> values;
+
+    Dataset() : values(1000000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // stands in for loading a file
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<double>(i) * 0.5;
+        }
+        ++builds;
+    }
+};
+
+struct Settings {
+    double scale;
+};
+
+// Per-test fixture with setUp/tearDown
+struct Scratch {
+    static inline std::atomic<int> tearDowns{ 0 };
+    std::vector<double> buffer;
+
+    void setUp() { buffer.assign(16, 1.0); }
+    void tearDown() { ++tearDowns; }
+};
+
+void fixtureTest() {
+    UnitTest<double>& doubleTest = UnitTest<double>::getInstance();
+
+    std::cout << "\n===== Testing fixtures =====" << std::endl;
+
+    setGlobalFixtureFactory<Settings>([]() { return Settings{ 0.5 }; });
+
+    for (std::size_t i = 0; i < 1000; ++i) {
+        doubleTest.addAssertion([&doubleTest, i]() {
+            const Dataset& data = doubleTest.suiteFixture<Dataset>();
+            return doubleTest.assertEqual(data.values[i * 997], static_cast<double>(i * 997) * globalFixture<Settings>().scale);
+            });
+    }
+    for (int i = 0; i < 100; ++i) {
+        doubleTest.addFixtureAssertion<Scratch>([&doubleTest](Scratch& scratch, int i) {
+            scratch.buffer[i % 16] += i;
+            return doubleTest.assertEqual(scratch.buffer[i % 16], 1.0 + i);
+            }, i);
+    }
+
+    ConsoleReporter quietReporter(std::cout, true);
+    Reporter::setCurrent(&quietReporter);
+    auto start = std::chrono::steady_clock::now();
+    TestSummary summary = doubleTest.runTestsParallel();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Reporter::setCurrent(nullptr);
+
+    std::cout << "Fixture run: " << summary.passed << " passed, " << summary.failed << " failed in " << elapsed.count() << " ms, dataset built "
+        << Dataset::builds << " time(s), " << Scratch::tearDowns << " per-test teardowns, "
+        << FixtureRegistry::getInstance().liveCount() << " shared fixture(s) still alive" << std::endl;
+    FixtureRegistry::getInstance().teardownAll();
+    TestRegistry::getInstance().clear();
+}
+
+void diffTest() {
+    UnitTest<std::vector<int>>& vectorTest = UnitTest<std::vector<int>>::getInstance();
+    UnitTest<std::string>& stringTest = UnitTest<std::string>::getInstance();
+    UnitTest<std::map<std::string, int>>& mapTest = UnitTest<std::map<std::string, int>>::getInstance();
+
+    std::cout << "\n===== Testing failure diffs =====" << std::endl;
+
+    // 10M elements, one changed and one inserted in the middle
+    std::vector<int> actual(10000000);
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        actual[i] = static_cast<int>(i);
+    }
+    std::vector<int> expected = actual;
+    expected[5000000] = -1;
+    expected.insert(expected.begin() + 5000010, 42);
+    auto start = std::chrono::steady_clock::now();
+    vectorTest.assertEqual(actual, expected);  // Fail
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "10M element diff in " << elapsed.count() << " ms" << std::endl;
+
+    // Nothing in common after the first element: too many edits, first divergence only
+    std::vector<int> shuffled(actual.rbegin(), actual.rend());
+    shuffled[0] = 0;
+    vectorTest.assertEqual(actual, shuffled);  // Fail
+
+    stringTest.assertEqual(std::string("the quick brown fox jumps over the lazy dog"), std::string("the quick brown cat jumps over the lazy dog"));  // Fail
+    stringTest.assertEqual(std::string("alpha\nbeta\ngamma\ndelta\nepsilon"), std::string("alpha\nbeta\ngamma!\ndelta\nzeta\nepsilon"));  // Fail
+
+    mapTest.assertEqual({ { "a", 1 }, { "b", 2 }, { "c", 3 } }, { { "a", 1 }, { "b", 20 }, { "d", 4 } });  // Fail
+}
+
+// Spinlocks for the stress demo: a correct one and one that tests and sets in two steps
+struct SpinLock {
+    std::atomic<bool> locked{ false };
+    void lock(StressContext&) { while (locked.exchange(true, std::memory_order_acquire)) std::this_thread::yield(); }
+    void unlock() { locked.store(false, std::memory_order_release); }
+};
+
+struct BrokenSpinLock {
+    std::atomic<bool> locked{ false };
+    void lock(StressContext& context) {
+        while (locked.load(std::memory_order_acquire)) std::this_thread::yield();
+        context.yield();  // the window between the test and the set
+        locked.store(true, std::memory_order_release);
+    }
+    void unlock() { locked.store(false, std::memory_order_release); }
+};
+
+void stressTest() {
+    UnitTest<long>& longTest = UnitTest<long>::getInstance();
+
+    std::cout << "\n===== Testing stress runs =====" << std::endl;
+
+    StressOptions options;
+    options.threads = 4;
+    options.iterations = 20000;
+    options.roundLength = 1000;
+    options.seed = 0xc0ffee;
+
+    // Lost updates: every round barrier compares the counter with the increments done so far
+    std::atomic<long> counter{ 0 };
+    std::atomic<long> increments{ 0 };
+    auto balanced = [&counter, &increments]() { return counter.load() == increments.load(); };
+    longTest.assertStress([&counter, &increments](StressContext&) {
+        counter.fetch_add(1);
+        increments.fetch_add(1);
+        }, options, balanced, "fetchAdd");
+
+    counter = 0;
+    increments = 0;
+    longTest.assertStress([&counter, &increments](StressContext& context) {
+        const long value = counter.load();
+        context.yield();
+        counter.store(value + 1);
+        increments.fetch_add(1);
+        }, options, balanced, "loadThenStore");  // Fail
+
+    // Mutual exclusion: the owner must not change inside the critical section
+    SpinLock lock;
+    std::atomic<std::size_t> owner{ SIZE_MAX };
+    auto exclusive = [&owner](auto& lock, StressContext& context) {
+        lock.lock(context);
+        context.check(owner.exchange(context.thread) == SIZE_MAX, "two threads in the critical section");
+        context.yield();
+        context.check(owner.exchange(SIZE_MAX) == context.thread, "owner changed in the critical section");
+        lock.unlock();
+    };
+    longTest.assertStress([&](StressContext& context) { exclusive(lock, context); }, options, {}, "spinLock");
+
+    BrokenSpinLock broken;
+    options.stopOnFailure = true;
+    longTest.assertStress([&](StressContext& context) { exclusive(broken, context); }, options, {}, "brokenSpinLock");  // Fail
+}
+
+// Self-registered tests; SelfRegisteredTests.cpp has more, run by the cpptf_main runner instead of a main()
+TEST(Demo, addition) {
+    return UnitTest<int>::getInstance().assertEqual(2 + 2, 4);
+}
+
+TEST_TAGGED(Demo, division, "fast") {
+    return UnitTest<int>::getInstance().assertEqual(7 / 2, 3);
+}
+
+void autoRegistrationTest() {
+    std::cout << "\n===== Testing self-registered tests =====" << std::endl;
+
+    TestRegistry& registry = TestRegistry::getInstance();
+    registry.clear();
+    std::cout << AutoTests::size() << " tests linked:";
+    for (const AutoTest* test : AutoTests::list()) {
+        std::cout << " " << test->suite << "::" << test->name;
+    }
+    std::cout << std::endl;
+
+    runAutoTests();
+
+    RegistryRunOptions options;
+    options.filter = TestFilter::parse("Demo::*");
+    TestSummary summary = registry.runAll(options);
+    std::cout << "Demo::* only: " << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+    registry.clear();
+}
+
 int main()
 {
     /*
@@ -349,9 +971,47 @@ int main()
 
     //noneTest();
 
-    //assertInTest();
+    assertInTest();
 
     //testAssertInstance();
 
+    parallelRunTest();
+
+    registryRunTest();
+
+    quietReporterTest();
+
+    structuredReporterTest();
+
+    benchmarkTest();
+
+    allocationTest();
+
+    arenaAssertionTest();
+
+    rangeAssertionTest();
+
+    isolatedRunTest();
+
+    timeoutTest();
+
+    timingReportTest();
+
+    filterTest();
+
+    asyncAssertionTest();
+
+    parameterizedTest();
+
+    propertyTest();
+
+    fixtureTest();
+
+    diffTest();
+
+    autoRegistrationTest();
+
+    stressTest();
+
 	return 0;
 }
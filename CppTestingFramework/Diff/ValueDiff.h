@@ -0,0 +1,556 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<iterator>
+#include<ranges>
+#include<concepts>
+#include<ostream>
+#include<streambuf>
+#include<limits>
+#include<algorithm>
+#include<type_traits>
+
+// Structural failure diffs for assertEqual on strings, sequences and associative containers.
+// Multisets and multimaps are compared by how often each key occurs: ordered ones as sorted sequences,
+// unordered ones key group by key.
+//
+// Every diff starts from the first divergence: common prefix and suffix are skipped with a plain linear
+// scan, and only the differing middle goes through a Myers diff (O((N + M) * D), D = number of edits),
+// and only while it stays under DiffOptions::maxEdits and maxMiddle. Past that the report falls back to
+// the first divergence alone.
+// Output is bounded as well: each value is cut after maxValueChars (its operator<< is stopped, not just
+// trimmed afterwards), and the whole diff after maxLines lines, so a failing comparison of two 10M-element
+// vectors prints a few dozen lines in about the time of one pass over them.
+
+struct DiffOptions {
+    std::size_t context = 3;           // unchanged elements shown around each change
+    std::size_t maxLines = 40;         // diff lines printed before "..."
+    std::size_t maxValueChars = 120;   // characters of one formatted value
+    std::size_t maxEdits = 256;        // Myers gives up beyond this many insertions + deletions
+    std::size_t maxMiddle = 1 << 16;   // longest differing middle (per side) handed to Myers
+    std::size_t maxKeys = 20;          // key differences listed for associative containers
+};
+
+namespace cpptf_diff_detail {
+    // streambuf that keeps at most limit characters, then fails so the writing operator<< stops early
+    class BoundedBuffer : public std::streambuf {
+    private:
+        std::string& text;
+        std::size_t limit;
+
+    public:
+        bool truncated = false;
+
+        BoundedBuffer(std::string& text, std::size_t limit) : text(text), limit(limit) {}
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::not_eof(c);
+            }
+            if (text.size() >= limit) {
+                truncated = true;
+                return traits_type::eof();
+            }
+            text.push_back(traits_type::to_char_type(c));
+            return c;
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize count) override {
+            const std::size_t room = limit - std::min(limit, text.size());
+            const std::size_t taken = std::min(room, static_cast<std::size_t>(count));
+            text.append(s, taken);
+            if (taken < static_cast<std::size_t>(count)) {
+                truncated = true;
+            }
+            return static_cast<std::streamsize>(taken);
+        }
+    };
+
+    template <typename U>
+    constexpr bool isStreamable = requires(std::ostream & os, const U & value) { os << value; };
+
+    template <typename U>
+    constexpr bool isString = std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>;
+
+    template <typename U>
+    constexpr bool isAssociative = requires(const U & container, const typename U::key_type & key) {
+        container.find(key);
+        container.end();
+    };
+
+    template <typename U>
+    constexpr bool isMap = isAssociative<U> && requires { typename U::mapped_type; };
+
+    // multiset, multimap and their unordered forms: insert() always succeeds and returns the iterator
+    template <typename U>
+    constexpr bool isMulti = isAssociative<U> && requires(U & container, const typename U::value_type & value) {
+        { container.insert(value) } -> std::same_as<typename U::iterator>;
+    };
+
+    template <typename U>
+    constexpr bool isOrdered = requires { typename U::key_compare; };
+
+    template <typename U>
+    constexpr bool isSequence = !isString<U> && !isAssociative<U> && std::ranges::sized_range<const U>
+        && std::ranges::forward_range<const U>;
+
+    // operator<< of value, cut after maxChars characters; precision and flags of os
+    template <typename U>
+    void writeBounded(std::ostream& os, const U& value, std::size_t maxChars) {
+        std::string text;
+        BoundedBuffer buffer(text, maxChars);
+        std::ostream bounded(&buffer);
+        bounded.copyfmt(os);
+        bounded.exceptions(std::ios::goodbit);
+        bounded << value;
+        os << text;
+        if (buffer.truncated) {
+            os << "...";
+        }
+    }
+
+    // One element of a diff: strings quoted, values without operator<< by size only
+    template <typename U>
+    void writeValue(std::ostream& os, const U& value, std::size_t maxChars) {
+        if constexpr (isString<U>) {
+            os << '"';
+            writeBounded(os, value, maxChars);
+            os << '"';
+        }
+        else if constexpr (isStreamable<U>) {
+            writeBounded(os, value, maxChars);
+        }
+        else {
+            os << "<" << sizeof(U) << "-byte value>";
+        }
+    }
+
+    enum class Edit : unsigned char { Same, Remove, Insert };  // Remove = only in actual, Insert = only in expected
+
+    // Myers' greedy shortest edit script between a[0, n) and b[0, m); equal(i, j) compares a[i] and b[j].
+    // Returns false when more than maxEdits edits are needed.
+    template <typename Equal>
+    bool myers(std::size_t n, std::size_t m, Equal&& equal, std::size_t maxEdits, std::vector<Edit>& script) {
+        const std::ptrdiff_t N = static_cast<std::ptrdiff_t>(n);
+        const std::ptrdiff_t M = static_cast<std::ptrdiff_t>(m);
+        const std::ptrdiff_t maxD = static_cast<std::ptrdiff_t>(std::min<std::size_t>(maxEdits, n + m));
+        const std::ptrdiff_t offset = maxD + 1;
+        std::vector<std::ptrdiff_t> v(static_cast<std::size_t>(2 * offset + 1), 0);
+        std::vector<std::vector<std::ptrdiff_t>> trace;  // v after each d, for the backtrack
+
+        std::ptrdiff_t found = -1;
+        for (std::ptrdiff_t d = 0; d <= maxD && found < 0; ++d) {
+            for (std::ptrdiff_t k = -d; k <= d; k += 2) {
+                std::ptrdiff_t x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                    ? v[offset + k + 1]
+                    : v[offset + k - 1] + 1;
+                std::ptrdiff_t y = x - k;
+                while (x < N && y < M && equal(static_cast<std::size_t>(x), static_cast<std::size_t>(y))) {
+                    ++x;
+                    ++y;
+                }
+                v[offset + k] = x;
+                if (x >= N && y >= M) {
+                    found = d;
+                    break;
+                }
+            }
+            trace.push_back(v);
+        }
+        if (found < 0) {
+            return false;
+        }
+
+        // Walk back from (N, M) through the saved frontiers
+        script.clear();
+        std::ptrdiff_t x = N;
+        std::ptrdiff_t y = M;
+        for (std::ptrdiff_t d = found; d > 0; --d) {
+            const std::vector<std::ptrdiff_t>& previous = trace[static_cast<std::size_t>(d - 1)];
+            const std::ptrdiff_t k = x - y;
+            const bool down = k == -d || (k != d && previous[offset + k - 1] < previous[offset + k + 1]);
+            const std::ptrdiff_t previousK = down ? k + 1 : k - 1;
+            const std::ptrdiff_t previousX = previous[offset + previousK];
+            const std::ptrdiff_t previousY = previousX - previousK;
+            while (x > previousX && y > previousY) {
+                script.push_back(Edit::Same);
+                --x;
+                --y;
+            }
+            script.push_back(down ? Edit::Insert : Edit::Remove);
+            x = previousX;
+            y = previousY;
+        }
+        while (x > 0 && y > 0) {
+            script.push_back(Edit::Same);
+            --x;
+            --y;
+        }
+        std::reverse(script.begin(), script.end());
+        return true;
+    }
+
+    // Lines of "  [i] value", "- [i] actual", "+ [j] expected" with context around every change.
+    // at(side, index) writes one element of actual (side 0) or expected (side 1).
+    template <typename Write>
+    void writeScript(std::ostream& os, const std::vector<Edit>& script, std::size_t firstA, std::size_t firstB,
+        std::size_t prefixContext, std::size_t suffixContext, const DiffOptions& options, Write&& at) {
+        // Mark script positions within context of a change
+        const std::size_t total = script.size();
+        std::vector<bool> shown(total, false);
+        for (std::size_t i = 0; i < total; ++i) {
+            if (script[i] != Edit::Same) {
+                const std::size_t from = i >= options.context ? i - options.context : 0;
+                const std::size_t to = std::min(total, i + options.context + 1);
+                std::fill(shown.begin() + from, shown.begin() + to, true);
+            }
+        }
+
+        std::size_t lines = 0;
+        auto line = [&](char marker, int side, std::size_t index) {
+            if (lines++ == options.maxLines) {
+                os << "\n    ...";
+            }
+            if (lines > options.maxLines) {
+                return;
+            }
+            os << "\n    " << marker << " [" << index << "] ";
+            at(side, index);
+        };
+
+        // Context before the script comes from the common prefix
+        for (std::size_t i = firstA - prefixContext; i < firstA; ++i) {
+            line(' ', 0, i);
+        }
+        std::size_t a = firstA;
+        std::size_t b = firstB;
+        bool gap = false;
+        for (std::size_t i = 0; i < total; ++i) {
+            if (shown[i]) {
+                if (gap && lines < options.maxLines) {
+                    os << "\n    ...";
+                }
+                gap = false;
+                switch (script[i]) {
+                case Edit::Same: line(' ', 0, a); break;
+                case Edit::Remove: line('-', 0, a); break;
+                case Edit::Insert: line('+', 1, b); break;
+                }
+            }
+            else {
+                gap = true;
+            }
+            if (script[i] != Edit::Insert) ++a;
+            if (script[i] != Edit::Remove) ++b;
+        }
+        for (std::size_t i = 0; i < suffixContext; ++i) {
+            line(' ', 0, a + i);
+        }
+    }
+
+    // Random access view of any sized forward range: the range itself, or pointers to its elements
+    template <typename U>
+    class Indexed {
+    private:
+        using Element = std::ranges::range_value_t<const U>;
+        static constexpr bool direct = std::ranges::random_access_range<const U>;
+        const U& range;
+        std::vector<const Element*> pointers;
+
+    public:
+        explicit Indexed(const U& range) : range(range) {
+            if constexpr (!direct) {
+                pointers.reserve(std::ranges::size(range));
+                for (const auto& element : range) {
+                    pointers.push_back(&element);
+                }
+            }
+        }
+
+        std::size_t size() const { return static_cast<std::size_t>(std::ranges::size(range)); }
+
+        decltype(auto) operator[](std::size_t i) const {
+            if constexpr (direct) {
+                return std::ranges::begin(range)[static_cast<std::ptrdiff_t>(i)];
+            }
+            else {
+                return *pointers[i];
+            }
+        }
+    };
+
+    // Shared by sequences and multi-line strings
+    template <typename A, typename WriteElement>
+    void diffIndexed(std::ostream& os, const A& actual, const A& expected, const char* noun, const DiffOptions& options,
+        WriteElement&& writeElement) {
+        const std::size_t n = actual.size();
+        const std::size_t m = expected.size();
+        std::size_t prefix = 0;
+        while (prefix < n && prefix < m && actual[prefix] == expected[prefix]) {
+            ++prefix;
+        }
+        std::size_t suffix = 0;
+        while (suffix < n - prefix && suffix < m - prefix && actual[n - 1 - suffix] == expected[m - 1 - suffix]) {
+            ++suffix;
+        }
+
+        os << n << " vs " << m << ' ' << noun;
+        if (prefix == n && prefix == m) {
+            os << ", no element differs";
+            return;
+        }
+        os << ", first difference at [" << prefix << "] (-actual +expected)";
+
+        const std::size_t middleA = n - prefix - suffix;
+        const std::size_t middleB = m - prefix - suffix;
+        auto at = [&](int side, std::size_t index) { writeElement(side == 0 ? actual[index] : expected[index]); };
+
+        std::vector<Edit> script;
+        const bool diffed = middleA <= options.maxMiddle && middleB <= options.maxMiddle
+            && myers(middleA, middleB, [&](std::size_t i, std::size_t j) { return actual[prefix + i] == expected[prefix + j]; },
+                options.maxEdits, script);
+        if (!diffed) {
+            // Too many edits to be worth a script: first divergence with its context
+            os << ", more than " << options.maxEdits << " edits";
+            script.clear();
+            const std::size_t shownA = std::min(middleA, options.context + 1);
+            const std::size_t shownB = std::min(middleB, options.context + 1);
+            script.insert(script.end(), shownA, Edit::Remove);
+            script.insert(script.end(), shownB, Edit::Insert);
+            writeScript(os, script, prefix, prefix, std::min(prefix, options.context), 0, options, at);
+            if (shownA < middleA || shownB < middleB) {
+                os << "\n    ...";
+            }
+            return;
+        }
+
+        std::size_t edits = 0;
+        for (Edit edit : script) edits += edit != Edit::Same;
+        os << ", " << edits << (edits == 1 ? " edit" : " edits");
+        writeScript(os, script, prefix, prefix, std::min(prefix, options.context), std::min(suffix, options.context), options, at);
+    }
+
+    // Single line strings: offset of the first difference and an excerpt of both around it
+    inline void diffText(std::ostream& os, std::string_view actual, std::string_view expected, const DiffOptions& options) {
+        std::size_t prefix = 0;
+        while (prefix < actual.size() && prefix < expected.size() && actual[prefix] == expected[prefix]) {
+            ++prefix;
+        }
+        os << "lengths " << actual.size() << " vs " << expected.size() << ", first difference at offset " << prefix;
+        const std::size_t half = options.maxValueChars / 2;
+        const std::size_t from = prefix > half / 2 ? prefix - half / 2 : 0;
+        auto excerpt = [&](std::string_view text) {
+            std::string_view part = text.substr(std::min(from, text.size()), half);
+            os << (from > 0 ? "\"..." : "\"") << part << (from + part.size() < text.size() ? "...\"" : "\"");
+        };
+        os << "\n    - ";
+        excerpt(actual);
+        os << "\n    + ";
+        excerpt(expected);
+        os << "\n      " << std::string((from > 0 ? 4 : 1) + prefix - from, ' ') << '^';
+    }
+
+    inline std::vector<std::string_view> splitLines(std::string_view text) {
+        std::vector<std::string_view> lines;
+        while (true) {
+            const std::size_t end = text.find('\n');
+            lines.push_back(text.substr(0, end));
+            if (end == std::string_view::npos) {
+                return lines;
+            }
+            text.remove_prefix(end + 1);
+        }
+    }
+
+    // Unordered multisets / multimaps: per distinct key, how often it occurs on each side, and (multimaps)
+    // whether the values under it match in any order; listed up to maxKeys
+    template <typename U>
+    void diffUnorderedMulti(std::ostream& os, const U& actual, const U& expected, const DiffOptions& options) {
+        auto keyOf = [](const auto& entry) -> const typename U::key_type& {
+            if constexpr (isMap<U>) return entry.first;
+            else return entry;
+        };
+        std::size_t missing = 0;
+        std::size_t unexpected = 0;
+        std::size_t changed = 0;
+        std::size_t listed = 0;
+        std::string lines;
+        auto list = [&](char marker, const typename U::key_type& key, std::size_t inActual, std::size_t inExpected) {
+            if (listed++ >= options.maxKeys) {
+                return;
+            }
+            std::string text;
+            BoundedBuffer buffer(text, options.maxValueChars * 4);
+            std::ostream out(&buffer);
+            out.copyfmt(os);
+            out << "\n    " << marker << " ";
+            writeValue(out, key, options.maxValueChars);
+            out << " (" << inActual << " in actual, " << inExpected << " in expected)";
+            lines += text;
+        };
+
+        // Equal keys are adjacent in an unordered multi container, so each group is visited once
+        for (auto it = actual.begin(); it != actual.end();) {
+            const auto group = actual.equal_range(keyOf(*it));
+            const auto other = expected.equal_range(keyOf(*it));
+            const std::size_t inActual = static_cast<std::size_t>(std::distance(group.first, group.second));
+            const std::size_t inExpected = static_cast<std::size_t>(std::distance(other.first, other.second));
+            if (inActual > inExpected) {
+                unexpected += inActual - inExpected;
+                list('-', keyOf(*it), inActual, inExpected);
+            }
+            else if (inActual < inExpected) {
+                missing += inExpected - inActual;
+                list('+', keyOf(*it), inActual, inExpected);
+            }
+            else if constexpr (isMap<U>) {
+                if (!std::is_permutation(group.first, group.second, other.first, other.second)) {
+                    ++changed;
+                    list('~', keyOf(*it), inActual, inExpected);
+                }
+            }
+            it = group.second;
+        }
+        for (auto it = expected.begin(); it != expected.end();) {
+            const auto group = expected.equal_range(keyOf(*it));
+            if (actual.find(keyOf(*it)) == actual.end()) {
+                const std::size_t inExpected = static_cast<std::size_t>(std::distance(group.first, group.second));
+                missing += inExpected;
+                list('+', keyOf(*it), 0, inExpected);
+            }
+            it = group.second;
+        }
+
+        os << actual.size() << " vs " << expected.size() << " entries: " << unexpected << " more in actual (-), "
+            << missing << " more in expected (+)";
+        if constexpr (isMap<U>) {
+            os << ", " << changed << " with different values (~)";
+        }
+        os << lines;
+        if (listed > options.maxKeys) {
+            os << "\n    ... " << (listed - options.maxKeys) << " more";
+        }
+    }
+
+    // Keys only in actual, only in expected, and (maps) keys whose values differ; listed up to maxKeys
+    template <typename U>
+    void diffAssociative(std::ostream& os, const U& actual, const U& expected, const DiffOptions& options) {
+        std::size_t missing = 0;
+        std::size_t unexpected = 0;
+        std::size_t changed = 0;
+        std::size_t listed = 0;
+        std::string lines;  // built while counting, only the first maxKeys entries
+        auto list = [&](char marker, const auto& key, const auto* actualValue, const auto* expectedValue) {
+            if (listed++ >= options.maxKeys) {
+                return;
+            }
+            std::string text;
+            BoundedBuffer buffer(text, options.maxKeys * options.maxValueChars * 4);
+            std::ostream out(&buffer);
+            out.copyfmt(os);
+            out << "\n    " << marker << " ";
+            writeValue(out, key, options.maxValueChars);
+            if (actualValue != nullptr) {
+                out << ": ";
+                writeValue(out, *actualValue, options.maxValueChars);
+            }
+            if (expectedValue != nullptr) {
+                out << (actualValue != nullptr ? " != " : ": ");
+                writeValue(out, *expectedValue, options.maxValueChars);
+            }
+            lines += text;
+        };
+
+        for (auto it = actual.begin(); it != actual.end(); ++it) {
+            if constexpr (isMap<U>) {
+                auto other = expected.find(it->first);
+                if (other == expected.end()) {
+                    ++unexpected;
+                    list('-', it->first, &it->second, static_cast<decltype(&it->second)>(nullptr));
+                }
+                else if (!(it->second == other->second)) {
+                    ++changed;
+                    list('~', it->first, &it->second, &other->second);
+                }
+            }
+            else if (expected.find(*it) == expected.end()) {
+                ++unexpected;
+                list('-', *it, static_cast<const int*>(nullptr), static_cast<const int*>(nullptr));
+            }
+        }
+        for (auto it = expected.begin(); it != expected.end(); ++it) {
+            if constexpr (isMap<U>) {
+                if (actual.find(it->first) == actual.end()) {
+                    ++missing;
+                    list('+', it->first, static_cast<decltype(&it->second)>(nullptr), &it->second);
+                }
+            }
+            else if (actual.find(*it) == actual.end()) {
+                ++missing;
+                list('+', *it, static_cast<const int*>(nullptr), static_cast<const int*>(nullptr));
+            }
+        }
+
+        os << actual.size() << " vs " << expected.size() << " entries: " << unexpected << " only in actual (-), "
+            << missing << " only in expected (+)";
+        if constexpr (isMap<U>) {
+            os << ", " << changed << " with different values (~)";
+        }
+        os << lines;
+        if (listed > options.maxKeys) {
+            os << "\n    ... " << (listed - options.maxKeys) << " more";
+        }
+    }
+}
+
+template <typename U>
+constexpr bool isDiffable = cpptf_diff_detail::isString<U> || cpptf_diff_detail::isAssociative<U>
+    || cpptf_diff_detail::isSequence<U>;
+
+// Diff of two unequal values; only for isDiffable<U>
+template <typename U>
+void writeDiff(std::ostream& os, const U& actual, const U& expected, const DiffOptions& options = {}) {
+    using namespace cpptf_diff_detail;
+    if constexpr (isString<U>) {
+        std::string_view a(actual);
+        std::string_view b(expected);
+        if (a.find('\n') == std::string_view::npos && b.find('\n') == std::string_view::npos) {
+            diffText(os, a, b, options);
+        }
+        else {
+            const std::vector<std::string_view> linesA = splitLines(a);
+            const std::vector<std::string_view> linesB = splitLines(b);
+            diffIndexed(os, linesA, linesB, "lines", options, [&](std::string_view line) { writeValue(os, line, options.maxValueChars); });
+        }
+    }
+    else if constexpr (isMulti<U> && isOrdered<U>) {
+        // A key can repeat, so membership says nothing; sorted iteration makes them sequences
+        const Indexed<U> a(actual);
+        const Indexed<U> b(expected);
+        diffIndexed(os, a, b, "entries", options, [&](const auto& entry) {
+            if constexpr (isMap<U>) {
+                writeValue(os, entry.first, options.maxValueChars);
+                os << ": ";
+                writeValue(os, entry.second, options.maxValueChars);
+            }
+            else {
+                writeValue(os, entry, options.maxValueChars);
+            }
+            });
+    }
+    else if constexpr (isMulti<U>) {
+        diffUnorderedMulti(os, actual, expected, options);
+    }
+    else if constexpr (isAssociative<U>) {
+        diffAssociative(os, actual, expected, options);
+    }
+    else {
+        const Indexed<U> a(actual);
+        const Indexed<U> b(expected);
+        diffIndexed(os, a, b, "elements", options, [&](const auto& element) { writeValue(os, element, options.maxValueChars); });
+    }
+}
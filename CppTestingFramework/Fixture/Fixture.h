@@ -0,0 +1,207 @@
+#pragma once
+#include<cstddef>
+#include<vector>
+#include<mutex>
+#include<atomic>
+#include<functional>
+#include<new>
+#include<utility>
+#include<algorithm>
+#include "../Watchdog/Watchdog.h"
+#include "../Profiler/TimingRecorder.h"
+
+// Test fixtures in three scopes.
+//
+//   per test   UnitTest<T>::addFixtureAssertion<F>: a fresh F on the stack of every run of the assertion,
+//              with optional setUp()/tearDown() members called around it.
+//   per suite  UnitTest<T>::suiteFixture<F>(): built on first use, shared by every assertion of the suite,
+//              torn down when the run that built it ends (runTests, runTestsParallel, TestRegistry::runAll).
+//   global     globalFixture<F>(): built on first use, shared by every suite, torn down by
+//              FixtureRegistry::teardownAll() or at exit.
+//
+// Shared fixtures are handed out as const F&: workers only read them, so no locking after the first build.
+// A fixture is built by its factory when one was set, by F() otherwise. Building it (or waiting for another
+// thread to build it) is paused out of the assertion's timeout and timing.
+
+enum class FixtureScope { Suite, Global };
+
+// Built shared fixtures in build order, so they are torn down once and in reverse order
+class FixtureRegistry {
+private:
+    struct Built {
+        void (*teardown)(void* fixture);
+        void* fixture;
+        FixtureScope scope;
+        const void* owner;  // suite of a suite fixture
+    };
+
+    std::mutex mutex;
+    std::vector<Built> built;
+
+    FixtureRegistry() = default;
+    ~FixtureRegistry() { teardownAll(); }
+
+    FixtureRegistry(const FixtureRegistry&) = delete;
+    FixtureRegistry& operator=(const FixtureRegistry&) = delete;
+
+public:
+    static FixtureRegistry& getInstance() {
+        static FixtureRegistry instance;
+        return instance;
+    }
+
+    void add(void (*teardown)(void*), void* fixture, FixtureScope scope, const void* owner) {
+        std::lock_guard<std::mutex> lock(mutex);
+        built.push_back({ teardown, fixture, scope, owner });
+    }
+
+    // Tear down the built fixtures of scope, only those of owner when it is not null
+    void teardown(FixtureScope scope, const void* owner = nullptr);
+    void teardownAll();
+
+    // Drop fixture from the list without tearing it down
+    void forget(const void* fixture) {
+        std::lock_guard<std::mutex> lock(mutex);
+        built.erase(std::remove_if(built.begin(), built.end(), [fixture](const Built& entry) { return entry.fixture == fixture; }), built.end());
+    }
+
+    std::size_t liveCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return built.size();
+    }
+};
+
+// One lazily built shared fixture. The object lives in inline storage, so building it costs whatever
+// F's constructor costs and nothing more.
+template <typename F>
+class SharedFixture {
+private:
+    alignas(F) unsigned char storage[sizeof(F)];
+    std::atomic<bool> ready{ false };
+    std::mutex buildMutex;
+    std::function<F()> factory;
+    FixtureScope scope;
+    const void* owner;
+
+    F* object() { return std::launder(reinterpret_cast<F*>(storage)); }
+
+    void destroyObject();
+    static void destroy(void* fixture) { static_cast<SharedFixture<F>*>(fixture)->destroyObject(); }
+
+public:
+    // Touches the registry first, so it outlives every fixture slot during static destruction
+    explicit SharedFixture(FixtureScope scope, const void* owner = nullptr) : scope(scope), owner(owner) {
+        FixtureRegistry::getInstance();
+    }
+    ~SharedFixture() { teardown(); }
+
+    SharedFixture(const SharedFixture&) = delete;
+    SharedFixture& operator=(const SharedFixture&) = delete;
+
+    // Used by the next build
+    void setFactory(std::function<F()> build) {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        factory = std::move(build);
+    }
+
+    // Builds on the first call; concurrent first callers wait for that one build.
+    // A throwing factory leaves the fixture unbuilt, the next call tries again.
+    const F& get();
+
+    bool built() const { return ready.load(std::memory_order_acquire); }
+
+    // Destroy the object; the next get() builds it again
+    void teardown();
+};
+
+
+inline void FixtureRegistry::teardown(FixtureScope scope, const void* owner) {
+    std::vector<Built> matching;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto split = std::stable_partition(built.begin(), built.end(), [scope, owner](const Built& fixture) {
+            return !(fixture.scope == scope && (owner == nullptr || fixture.owner == owner));
+            });
+        matching.assign(split, built.end());
+        built.erase(split, built.end());
+    }
+    // Outside the lock: a teardown may use other fixtures
+    for (auto it = matching.rbegin(); it != matching.rend(); ++it) {
+        it->teardown(it->fixture);
+    }
+}
+
+inline void FixtureRegistry::teardownAll() {
+    teardown(FixtureScope::Suite);
+    teardown(FixtureScope::Global);
+}
+
+template <typename F>
+const F& SharedFixture<F>::get() {
+    if (!ready.load(std::memory_order_acquire)) {
+        Watchdog::Pause watchPause;
+        TimingPause timingPause;
+        std::lock_guard<std::mutex> lock(buildMutex);
+        if (!ready.load(std::memory_order_relaxed)) {
+            if (factory) {
+                ::new (static_cast<void*>(storage)) F(factory());
+            }
+            else {
+                ::new (static_cast<void*>(storage)) F();
+            }
+            FixtureRegistry::getInstance().add(&SharedFixture<F>::destroy, this, scope, owner);
+            ready.store(true, std::memory_order_release);
+        }
+    }
+    return *object();
+}
+
+template <typename F>
+void SharedFixture<F>::teardown() {
+    FixtureRegistry::getInstance().forget(this);
+    destroyObject();
+}
+
+template <typename F>
+void SharedFixture<F>::destroyObject() {
+    std::lock_guard<std::mutex> lock(buildMutex);
+    if (ready.exchange(false, std::memory_order_acq_rel)) {
+        object()->~F();
+    }
+}
+
+// Process wide instance of F
+template <typename F>
+SharedFixture<F>& globalFixtureSlot() {
+    static SharedFixture<F> slot(FixtureScope::Global);
+    return slot;
+}
+
+template <typename F>
+const F& globalFixture() {
+    return globalFixtureSlot<F>().get();
+}
+
+template <typename F>
+void setGlobalFixtureFactory(std::function<F()> factory) {
+    globalFixtureSlot<F>().setFactory(std::move(factory));
+}
+
+namespace cpptf_fixture_detail {
+    // Per-test fixture: constructed for one run of one assertion, setUp()/tearDown() called when present
+    template <typename F>
+    struct Scoped {
+        F fixture;
+
+        Scoped() {
+            if constexpr (requires(F & f) { f.setUp(); }) {
+                fixture.setUp();
+            }
+        }
+        ~Scoped() {
+            if constexpr (requires(F & f) { f.tearDown(); }) {
+                fixture.tearDown();
+            }
+        }
+    };
+}
@@ -1,3 +1,8 @@
+#pragma once
+#include<functional>
+#include<tuple>
+#include<utility>
+
 // A structure to store functions and their arguments
 template <typename... Args>
 struct FunctionWrapper {
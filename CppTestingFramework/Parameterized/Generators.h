@@ -0,0 +1,275 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<cmath>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<tuple>
+#include<array>
+#include<charconv>
+#include<stdexcept>
+#include<type_traits>
+#include<initializer_list>
+#include<utility>
+#include<limits>
+#include<algorithm>
+#include "MappedFile.h"
+
+// Lazy argument generators for UnitTest<T>::addParameterized.
+//
+// A generator is any object with
+//     std::size_t size() const;          number of cases
+//     value_type at(std::size_t i) const; the i-th case, built on demand
+// Cases are never stored: the runner asks for case i when it runs it, so a million-case table is one
+// generator object plus whatever the data source needs (a mapped file and a row index for CSV).
+// at() must be safe to call from several threads at once, batches of one table may run in parallel.
+
+template <typename G>
+concept CaseGenerator = requires(const G& generator, std::size_t i) {
+    { generator.size() } -> std::convertible_to<std::size_t>;
+    generator.at(i);
+};
+
+// first, first + step, ... while below last (above last for a negative step)
+template <typename U>
+class RangeGenerator {
+private:
+    U first;
+    U step;
+    std::size_t count;
+
+public:
+    using value_type = U;
+
+    RangeGenerator(U first, U last, U step) : first(first), step(step), count(0) {
+        if constexpr (std::is_floating_point_v<U>) {
+            if ((step > U{ 0 } && last > first) || (step < U{ 0 } && last < first)) {
+                count = static_cast<std::size_t>(std::ceil((last - first) / step));
+            }
+        }
+        else {
+            // Distance and step magnitude in the unsigned type: range(INT_MIN, INT_MAX) must not overflow
+            using W = std::make_unsigned_t<U>;
+            if (step > U{ 0 } && last > first) {
+                count = steps(static_cast<W>(static_cast<W>(last) - static_cast<W>(first)), static_cast<W>(step));
+            }
+            else if (step < U{ 0 } && last < first) {
+                count = steps(static_cast<W>(static_cast<W>(first) - static_cast<W>(last)), static_cast<W>(W{ 0 } - static_cast<W>(step)));
+            }
+        }
+    }
+
+    std::size_t size() const { return count; }
+    U at(std::size_t i) const {
+        if constexpr (std::is_floating_point_v<U>) {
+            return static_cast<U>(first + static_cast<U>(i) * step);
+        }
+        else {
+            // Computed in the unsigned type and converted back, the intermediate first + i * step may not fit in U
+            using W = std::make_unsigned_t<U>;
+            return static_cast<U>(static_cast<W>(static_cast<W>(first) + static_cast<W>(i) * static_cast<W>(step)));
+        }
+    }
+
+private:
+    // ceil(distance / stride) without distance + stride - 1 overflowing
+    template <typename W>
+    static std::size_t steps(W distance, W stride) {
+        return static_cast<std::size_t>(distance / stride + (distance % stride != 0 ? 1 : 0));
+    }
+};
+
+template <typename U>
+RangeGenerator<U> range(U first, U last, U step = U{ 1 }) {
+    return RangeGenerator<U>(first, last, step);
+}
+
+// An explicit list of cases
+template <typename U>
+class ValuesGenerator {
+private:
+    std::vector<U> items;
+
+public:
+    using value_type = U;
+
+    explicit ValuesGenerator(std::vector<U> items) : items(std::move(items)) {}
+
+    std::size_t size() const { return items.size(); }
+    const U& at(std::size_t i) const { return items[i]; }
+};
+
+template <typename U>
+ValuesGenerator<U> values(std::initializer_list<U> items) {
+    return ValuesGenerator<U>(std::vector<U>(items));
+}
+
+// Every combination of the inner generators' cases as a tuple; the last generator varies fastest.
+// Case i is decoded from i as a mixed radix number, so nothing is materialised.
+template <typename... Generators>
+class CartesianGenerator {
+private:
+    std::tuple<Generators...> generators;
+    std::array<std::size_t, sizeof...(Generators)> sizes;
+    std::size_t count;
+
+    template <std::size_t... I>
+    auto build(std::size_t i, std::index_sequence<I...>) const {
+        std::array<std::size_t, sizeof...(Generators)> digits{};
+        for (std::size_t k = sizeof...(Generators); k-- > 0;) {
+            digits[k] = i % sizes[k];
+            i /= sizes[k];
+        }
+        return std::tuple<std::decay_t<decltype(std::get<I>(generators).at(0))>...>(std::get<I>(generators).at(digits[I])...);
+    }
+
+public:
+    explicit CartesianGenerator(Generators... inner) : generators(std::move(inner)...), count(1) {
+        std::size_t k = 0;
+        std::apply([this, &k](const Generators&... generator) { ((sizes[k++] = generator.size()), ...); }, generators);
+        if (std::find(sizes.begin(), sizes.end(), std::size_t{ 0 }) != sizes.end()) {
+            count = 0;
+            return;
+        }
+        for (std::size_t size : sizes) {
+            if (count > std::numeric_limits<std::size_t>::max() / size) {
+                throw std::overflow_error("cartesian: the number of combinations does not fit in std::size_t");
+            }
+            count *= size;
+        }
+    }
+
+    std::size_t size() const { return count; }
+    auto at(std::size_t i) const { return build(i, std::index_sequence_for<Generators...>{}); }
+};
+
+template <CaseGenerator... Generators>
+CartesianGenerator<std::decay_t<Generators>...> cartesian(Generators&&... generators) {
+    return CartesianGenerator<std::decay_t<Generators>...>(std::forward<Generators>(generators)...);
+}
+
+namespace cpptf_csv_detail {
+    template <typename U>
+    U parseField(std::string_view field, std::size_t row, std::size_t column) {
+        if constexpr (std::is_same_v<U, std::string_view>) {
+            return field;
+        }
+        else if constexpr (std::is_same_v<U, std::string>) {
+            return std::string(field);
+        }
+        else if constexpr (std::is_same_v<U, bool>) {
+            return field == "1" || field == "true";
+        }
+        else {
+            static_assert(std::is_arithmetic_v<U>, "CSV fields must be arithmetic, bool, std::string or std::string_view");
+            while (!field.empty() && field.front() == ' ') field.remove_prefix(1);
+            while (!field.empty() && (field.back() == ' ' || field.back() == '\r')) field.remove_suffix(1);
+            U value{};
+            auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+            if (error != std::errc() || end != field.data() + field.size()) {
+                throw std::runtime_error("CSV row " + std::to_string(row) + ", column " + std::to_string(column)
+                    + ": cannot parse '" + std::string(field) + "'");
+            }
+            return value;
+        }
+    }
+}
+
+// Rows of a memory-mapped CSV file as std::tuple<Fields...>.
+// Only the start offset of each row is kept (8 bytes per row); fields are parsed when the row is asked for.
+// Plain delimiter separated values: no quoting or escaped delimiters. std::string_view fields point into
+// the mapping and stay valid as long as the generator.
+template <typename... Fields>
+class CsvGenerator {
+private:
+    MappedFile file;
+    std::vector<std::size_t> rowStarts;
+    char delimiter;
+
+    template <std::size_t... I>
+    std::tuple<Fields...> parse(std::size_t i, std::string_view line, std::index_sequence<I...>) const {
+        std::array<std::string_view, sizeof...(Fields)> fields{};
+        std::size_t column = 0;
+        while (column < fields.size()) {
+            std::size_t cut = line.find(delimiter);
+            fields[column++] = line.substr(0, cut);
+            if (cut == std::string_view::npos) {
+                break;
+            }
+            line.remove_prefix(cut + 1);
+        }
+        if (column < fields.size()) {
+            throw std::runtime_error("CSV row " + std::to_string(i) + ": expected " + std::to_string(fields.size())
+                + " fields, found " + std::to_string(column));
+        }
+        return std::tuple<Fields...>(cpptf_csv_detail::parseField<Fields>(fields[I], i, I)...);
+    }
+
+public:
+    using value_type = std::tuple<Fields...>;
+
+    explicit CsvGenerator(const std::string& path, bool skipHeader = true, char delimiter = ',')
+        : file(path), delimiter(delimiter) {
+        std::string_view text = file.view();
+        std::size_t position = 0;
+        bool header = skipHeader;
+        while (position < text.size()) {
+            std::size_t end = text.find('\n', position);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            const bool blank = end == position || (end == position + 1 && text[position] == '\r');
+            if (!blank && !std::exchange(header, false)) {
+                rowStarts.push_back(position);
+            }
+            position = end + 1;
+        }
+    }
+
+    std::size_t size() const { return rowStarts.size(); }
+
+    value_type at(std::size_t i) const {
+        std::string_view text = file.view();
+        std::string_view line = text.substr(rowStarts[i]);
+        line = line.substr(0, line.find('\n'));
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return parse(i, line, std::index_sequence_for<Fields...>{});
+    }
+};
+
+template <typename... Fields>
+CsvGenerator<Fields...> csvRows(const std::string& path, bool skipHeader = true, char delimiter = ',') {
+    return CsvGenerator<Fields...>(path, skipHeader, delimiter);
+}
+
+// Fixed size records of a memory-mapped binary fixture (trivially copyable Record, native byte order).
+// Trailing bytes that do not make up a whole record are ignored.
+template <typename Record>
+class BinaryGenerator {
+private:
+    static_assert(std::is_trivially_copyable_v<Record>, "binary fixture records must be trivially copyable");
+    MappedFile file;
+    std::size_t offset;
+
+public:
+    using value_type = Record;
+
+    explicit BinaryGenerator(const std::string& path, std::size_t headerBytes = 0) : file(path), offset(headerBytes) {}
+
+    std::size_t size() const { return file.size() > offset ? (file.size() - offset) / sizeof(Record) : 0; }
+
+    Record at(std::size_t i) const {
+        Record record;
+        std::memcpy(&record, file.data() + offset + i * sizeof(Record), sizeof(Record));
+        return record;
+    }
+};
+
+template <typename Record>
+BinaryGenerator<Record> binaryRecords(const std::string& path, std::size_t headerBytes = 0) {
+    return BinaryGenerator<Record>(path, headerBytes);
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include<cstddef>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<fstream>
+#include<iterator>
+#include<stdexcept>
+#include<utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include<windows.h>
+#define CPPTF_MAPPED_FILE_WIN32 1
+#elif __has_include(<sys/mman.h>)
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#define CPPTF_MAPPED_FILE_POSIX 1
+#endif
+
+// Read-only memory mapping of a whole fixture file. Pages are only read when a test case touches them,
+// so a large CSV or binary table costs address space, not heap.
+// Falls back to reading the file into memory where mapping is not available.
+class MappedFile {
+private:
+    const char* begin = nullptr;
+    std::size_t length = 0;
+#if defined(CPPTF_MAPPED_FILE_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#elif !defined(CPPTF_MAPPED_FILE_POSIX)
+    std::vector<char> contents;
+#endif
+
+    void close();
+
+public:
+    MappedFile() = default;
+    // Throws std::runtime_error when the file cannot be opened
+    explicit MappedFile(const std::string& path);
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return begin; }
+    std::size_t size() const { return length; }
+    std::string_view view() const { return { begin, length }; }
+};
+
+
+#if defined(CPPTF_MAPPED_FILE_POSIX)
+
+inline MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: cannot stat " + path);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("MappedFile: cannot map " + path);
+        }
+        ::madvise(mapped, length, MADV_SEQUENTIAL);
+        begin = static_cast<const char*>(mapped);
+    }
+    ::close(fd);  // the mapping keeps the file alive
+}
+
+inline void MappedFile::close() {
+    if (begin != nullptr) {
+        ::munmap(const_cast<char*>(begin), length);
+    }
+    begin = nullptr;
+    length = 0;
+}
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+    : begin(std::exchange(other.begin, nullptr)), length(std::exchange(other.length, 0)) {
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        begin = std::exchange(other.begin, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+#elif defined(CPPTF_MAPPED_FILE_WIN32)
+
+inline MappedFile::MappedFile(const std::string& path) {
+    file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    LARGE_INTEGER fileSize{};
+    ::GetFileSizeEx(file, &fileSize);
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    if (length > 0) {
+        mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            close();
+            throw std::runtime_error("MappedFile: cannot map " + path);
+        }
+        begin = static_cast<const char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (begin == nullptr) {
+            close();
+            throw std::runtime_error("MappedFile: cannot map " + path);
+        }
+    }
+}
+
+inline void MappedFile::close() {
+    if (begin != nullptr) ::UnmapViewOfFile(begin);
+    if (mapping != nullptr) ::CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) ::CloseHandle(file);
+    begin = nullptr;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+    length = 0;
+}
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+    : begin(std::exchange(other.begin, nullptr)), length(std::exchange(other.length, 0)),
+    file(std::exchange(other.file, INVALID_HANDLE_VALUE)), mapping(std::exchange(other.mapping, nullptr)) {
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        begin = std::exchange(other.begin, nullptr);
+        length = std::exchange(other.length, 0);
+        file = std::exchange(other.file, INVALID_HANDLE_VALUE);
+        mapping = std::exchange(other.mapping, nullptr);
+    }
+    return *this;
+}
+
+#else
+
+inline MappedFile::MappedFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    begin = contents.data();
+    length = contents.size();
+}
+
+inline void MappedFile::close() {
+    contents.clear();
+    begin = nullptr;
+    length = 0;
+}
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+    : length(std::exchange(other.length, 0)), contents(std::move(other.contents)) {
+    begin = contents.data();
+    other.begin = nullptr;
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        contents = std::move(other.contents);
+        begin = contents.data();
+        length = std::exchange(other.length, 0);
+        other.begin = nullptr;
+    }
+    return *this;
+}
+
+#endif
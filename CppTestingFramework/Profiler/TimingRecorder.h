@@ -0,0 +1,333 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<chrono>
+#include<atomic>
+#include<memory>
+#include<vector>
+#include<string>
+#include<string_view>
+#include<ostream>
+#include<iostream>
+#include<fstream>
+#include<iomanip>
+#include<algorithm>
+#include<cstring>
+#include "../Reporter/ReportFormat.h"
+
+// Per-assertion timings of runTests / runTestsParallel / TestRegistry::runAll.
+//
+// Opt-in via TimingRecorder::getInstance().enable(). While disabled the run loops only pay for one relaxed load.
+// While enabled every assertion costs two steady_clock reads and one 32 byte store into a ring buffer that
+// was allocated up front: no allocation, no lock, no formatting during the run. When the ring wraps the
+// oldest records are overwritten.
+// After each run of a suite the slowest-N assertions and a duration histogram of that run are printed
+// (TimingOptions::printAfterRun); writeChromeTrace() exports everything still in the ring as trace events.
+
+struct TimingRecord {
+    const char* suiteName;     // typeName().c_str() of the suite, lives for the whole program
+    std::uint32_t index;       // assertion index inside its run, the table position in TestRegistry runs
+    std::uint32_t thread;      // small per-thread id
+    std::int64_t startNs;      // steady_clock, relative to enable()
+    std::int64_t durationNs;
+};
+
+struct TimingOptions {
+    std::size_t capacity = 1 << 16;    // records kept, rounded up to a power of two
+    std::size_t slowest = 10;          // rows of the slowest-assertions table
+    bool printAfterRun = true;
+    std::ostream* out = nullptr;       // where printAfterRun writes, nullptr = std::cout
+};
+
+class TimingRecorder {
+private:
+    std::unique_ptr<TimingRecord[]> ring;
+    std::size_t mask = 0;
+    std::atomic<std::uint64_t> head{ 0 };
+    std::atomic<bool> recording{ false };
+    TimingOptions options;
+    std::chrono::steady_clock::time_point origin;
+
+    TimingRecorder() = default;
+    TimingRecorder(const TimingRecorder&) = delete;
+    TimingRecorder& operator=(const TimingRecorder&) = delete;
+
+    static std::uint32_t threadId() {
+        static std::atomic<std::uint32_t> next{ 0 };
+        thread_local std::uint32_t id = next.fetch_add(1, std::memory_order_relaxed) + 1;
+        return id;
+    }
+
+    // Histogram bucket b holds durations in [2^(b-1), 2^b) microseconds; bucket 0 is below 1 us
+    static constexpr std::size_t bucketCount = 24;
+    static std::size_t bucketOf(std::int64_t durationNs) {
+        std::uint64_t us = static_cast<std::uint64_t>(durationNs) / 1000;
+        std::size_t bucket = 0;
+        while (us > 0 && bucket + 1 < bucketCount) {
+            us >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    void writeSuite(std::ostream& os, std::string_view suiteName, std::vector<TimingRecord>& records, std::size_t dropped) const;
+
+public:
+    static TimingRecorder& getInstance();
+
+    // Allocates the ring and starts recording. Do not call while a run is in progress.
+    void enable(const TimingOptions& options = {});
+    void disable() { recording.store(false, std::memory_order_relaxed); }
+    bool enabled() const { return recording.load(std::memory_order_relaxed); }
+
+    std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void record(const char* suiteName, std::size_t index, std::int64_t startNs, std::int64_t durationNs) {
+        const std::uint64_t slot = head.fetch_add(1, std::memory_order_relaxed) & mask;
+        ring[slot] = { suiteName, static_cast<std::uint32_t>(index), threadId(), startNs, durationNs };
+    }
+
+    // Sequence number of the next record; a run remembers it to report only its own records
+    std::uint64_t position() const { return head.load(std::memory_order_relaxed); }
+
+    // Records written since position `from` that are still in the ring (oldest first)
+    std::vector<TimingRecord> recordsSince(std::uint64_t from) const;
+
+    // Slowest-N table plus histogram, one block per suite. Only call while nothing is being recorded.
+    void writeReport(std::ostream& os, std::uint64_t from = 0) const;
+    // Called by the run loops at the end of a run
+    void reportRun(std::uint64_t from) const;
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto) of every record still in the ring
+    void writeChromeTrace(std::ostream& os) const;
+    bool writeChromeTrace(const std::string& path) const;
+};
+
+// Time spent on this thread that belongs to no assertion (building a shared fixture); AssertionTimer
+// leaves it out. Nested pauses count once.
+class TimingPause {
+private:
+    inline static thread_local std::int64_t pausedNs = 0;
+    inline static thread_local unsigned depth = 0;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    TimingPause() {
+        if (depth++ == 0) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    ~TimingPause() {
+        if (--depth == 0) {
+            pausedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    TimingPause(const TimingPause&) = delete;
+    TimingPause& operator=(const TimingPause&) = delete;
+
+    // Paused nanoseconds of the calling thread so far
+    static std::int64_t total() { return pausedNs; }
+};
+
+// Times one assertion when the recorder is on
+class AssertionTimer {
+private:
+    TimingRecorder* recorder;
+    const char* suiteName;
+    std::size_t index;
+    std::int64_t start;
+    std::int64_t pausedAtStart;
+
+public:
+    AssertionTimer(const char* suiteName, std::size_t index) : recorder(nullptr), suiteName(suiteName), index(index), start(0), pausedAtStart(0) {
+        TimingRecorder& instance = TimingRecorder::getInstance();
+        if (instance.enabled()) {
+            recorder = &instance;
+            start = instance.now();
+            pausedAtStart = TimingPause::total();
+        }
+    }
+
+    ~AssertionTimer() {
+        if (recorder != nullptr) {
+            recorder->record(suiteName, index, start, recorder->now() - start - (TimingPause::total() - pausedAtStart));
+        }
+    }
+
+    AssertionTimer(const AssertionTimer&) = delete;
+    AssertionTimer& operator=(const AssertionTimer&) = delete;
+};
+
+// Brackets one run: remembers where its records start and prints them afterwards
+class TimedRun {
+private:
+    std::uint64_t from;
+    bool active;
+
+public:
+    TimedRun() : from(0), active(TimingRecorder::getInstance().enabled()) {
+        if (active) {
+            from = TimingRecorder::getInstance().position();
+        }
+    }
+
+    void finish() {
+        if (active) {
+            TimingRecorder::getInstance().reportRun(from);
+            active = false;
+        }
+    }
+};
+
+
+inline TimingRecorder& TimingRecorder::getInstance() {
+    static TimingRecorder recorder;
+    return recorder;
+}
+
+inline void TimingRecorder::enable(const TimingOptions& newOptions) {
+    options = newOptions;
+    std::size_t capacity = 1;
+    while (capacity < std::max<std::size_t>(options.capacity, 1)) {
+        capacity <<= 1;
+    }
+    if (ring == nullptr || mask + 1 != capacity) {
+        ring = std::make_unique<TimingRecord[]>(capacity);
+    }
+    mask = capacity - 1;
+    head.store(0, std::memory_order_relaxed);
+    origin = std::chrono::steady_clock::now();
+    recording.store(true, std::memory_order_relaxed);
+}
+
+inline std::vector<TimingRecord> TimingRecorder::recordsSince(std::uint64_t from) const {
+    std::vector<TimingRecord> records;
+    if (ring == nullptr) {
+        return records;
+    }
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    const std::uint64_t begin = std::max<std::uint64_t>(from, end > mask + 1 ? end - (mask + 1) : 0);
+    records.reserve(static_cast<std::size_t>(end - begin));
+    for (std::uint64_t i = begin; i < end; ++i) {
+        records.push_back(ring[i & mask]);
+    }
+    return records;
+}
+
+inline void TimingRecorder::reportRun(std::uint64_t from) const {
+    if (options.printAfterRun) {
+        writeReport(options.out != nullptr ? *options.out : std::cout, from);
+    }
+}
+
+inline void TimingRecorder::writeReport(std::ostream& os, std::uint64_t from) const {
+    std::vector<TimingRecord> records = recordsSince(from);
+    const std::uint64_t end = head.load(std::memory_order_relaxed);
+    const std::size_t dropped = static_cast<std::size_t>(end - from) - records.size();
+
+    // One block per suite, in order of first appearance
+    std::vector<const char*> suites;
+    for (const TimingRecord& record : records) {
+        if (std::find(suites.begin(), suites.end(), record.suiteName) == suites.end()) {
+            suites.push_back(record.suiteName);
+        }
+    }
+    std::vector<TimingRecord> suiteRecords;
+    for (const char* suite : suites) {
+        suiteRecords.clear();
+        for (const TimingRecord& record : records) {
+            if (record.suiteName == suite) {
+                suiteRecords.push_back(record);
+            }
+        }
+        writeSuite(os, suite, suiteRecords, suites.size() == 1 ? dropped : 0);
+    }
+}
+
+inline void TimingRecorder::writeSuite(std::ostream& os, std::string_view suiteName, std::vector<TimingRecord>& records, std::size_t dropped) const {
+    std::int64_t totalNs = 0;
+    for (const TimingRecord& record : records) {
+        totalNs += record.durationNs;
+    }
+
+    const std::ios::fmtflags savedFlags = os.flags();
+    const std::streamsize savedPrecision = os.precision();
+    os << std::fixed << std::setprecision(1);
+
+    os << "Timings for " << suiteName << ": " << records.size() << " assertions, " << totalNs / 1e3 << " us total";
+    if (dropped > 0) {
+        os << " (" << dropped << " older records overwritten, raise TimingOptions::capacity)";
+    }
+    os << '\n';
+
+    const std::size_t shown = std::min(options.slowest, records.size());
+    std::partial_sort(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(shown), records.end(),
+        [](const TimingRecord& a, const TimingRecord& b) { return a.durationNs > b.durationNs; });
+    for (std::size_t i = 0; i < shown; ++i) {
+        os << "  " << std::setw(3) << i + 1 << ". assertion #" << std::left << std::setw(6) << records[i].index << std::right
+            << std::setw(12) << records[i].durationNs / 1e3 << " us\n";
+    }
+
+    std::size_t buckets[bucketCount] = {};
+    for (const TimingRecord& record : records) {
+        ++buckets[bucketOf(record.durationNs)];
+    }
+    const std::size_t largest = *std::max_element(std::begin(buckets), std::end(buckets));
+    std::size_t first = 0;
+    std::size_t last = bucketCount;
+    while (first < bucketCount && buckets[first] == 0) ++first;
+    while (last > first && buckets[last - 1] == 0) --last;
+
+    constexpr std::size_t barWidth = 40;
+    for (std::size_t b = first; b < last; ++b) {
+        const std::uint64_t low = b == 0 ? 0 : std::uint64_t{ 1 } << (b - 1);
+        os << "  [" << std::setw(8) << low << " us, ";
+        if (b + 1 == bucketCount) {
+            os << std::setw(8) << "inf" << ")  ";
+        }
+        else {
+            os << std::setw(8) << (std::uint64_t{ 1 } << b) << " us)  ";
+        }
+        const std::size_t bar = largest == 0 ? 0 : (buckets[b] * barWidth + largest - 1) / largest;
+        os << std::string(bar, '#') << std::string(barWidth - bar, ' ') << ' ' << buckets[b] << '\n';
+    }
+
+    os.flags(savedFlags);
+    os.precision(savedPrecision);
+}
+
+inline void TimingRecorder::writeChromeTrace(std::ostream& os) const {
+    std::vector<TimingRecord> records = recordsSince(0);
+
+    const std::ios::fmtflags savedFlags = os.flags();
+    const std::streamsize savedPrecision = os.precision();
+    os << std::fixed << std::setprecision(3);
+
+    // "X" complete events, timestamps in microseconds
+    os << "{\"traceEvents\":[";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const TimingRecord& record = records[i];
+        os << (i == 0 ? "\n" : ",\n") << "{\"name\":\"";
+        writeJsonEscaped(os, record.suiteName);
+        os << '#' << record.index << "\",\"cat\":\"";
+        writeJsonEscaped(os, record.suiteName);
+        os << "\",\"ph\":\"X\",\"ts\":" << record.startNs / 1e3 << ",\"dur\":" << record.durationNs / 1e3
+            << ",\"pid\":1,\"tid\":" << record.thread << '}';
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    os.flags(savedFlags);
+    os.precision(savedPrecision);
+}
+
+inline bool TimingRecorder::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    writeChromeTrace(file);
+    return static_cast<bool>(file);
+}
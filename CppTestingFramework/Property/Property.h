@@ -0,0 +1,486 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cmath>
+#include<limits>
+#include<string>
+#include<vector>
+#include<atomic>
+#include<chrono>
+#include<memory>
+#include<ostream>
+#include<exception>
+#include<algorithm>
+#include<type_traits>
+#include<utility>
+#include "../ThreadPool/ThreadPool.h"
+
+// Property-based checks: a property is a predicate over generated inputs that must hold for every one of them.
+//
+// Every case i of a run gets its own random stream seeded from (seed, i), so a run is reproducible from its
+// seed alone, cases can be spread over any number of workers, and a single failing case can be replayed
+// (PropertyOptions::replayCase) without generating the ones before it.
+//
+// Generators are pluggable. A generator for U is any object with
+//     void generate(PropertyRng& rng, std::size_t size, U& out) const;   fill out, reusing its storage
+// and optionally
+//     bool shrink(const U& value, ShrinkSink<U> sink) const;             offer smaller candidates
+// Arbitrary<U> provides both for arithmetic types, bool, std::string and std::vector of those.
+//
+// checkProperty runs batches of cases on a ThreadPool, so the property and the generator are called from
+// several threads at once: both must be thread-safe (no unsynchronised shared state in captures).
+
+// xoshiro256** seeded through splitmix64: a few ns per draw and a good enough stream for test inputs
+class PropertyRng {
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    static std::uint64_t splitmix(std::uint64_t& x) {
+        std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    explicit PropertyRng(std::uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(std::uint64_t seed) {
+        for (std::uint64_t& word : state) {
+            word = splitmix(seed);
+        }
+    }
+
+    // Stream of case caseIndex of the run with the given seed
+    static PropertyRng forCase(std::uint64_t seed, std::uint64_t caseIndex) {
+        std::uint64_t mixed = seed ^ (caseIndex * 0xd1b54a32d192ed03ULL);
+        return PropertyRng(splitmix(mixed));
+    }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound), bound > 0 (multiply-shift where 128-bit products exist; the tiny bias does not matter here)
+    std::uint64_t below(std::uint64_t bound) {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+#else
+        return next() % bound;
+#endif
+    }
+
+    // Uniform in [0, 1)
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    bool chance(unsigned oneIn) { return below(oneIn) == 0; }
+};
+
+// Receives shrink candidates; returns true when the candidate still falsifies the property,
+// the generator should then stop and return true so shrinking restarts from that candidate
+template <typename U>
+struct ShrinkSink {
+    bool (*offer)(void* context, const U& candidate);
+    void* context;
+
+    bool operator()(const U& candidate) const { return offer(context, candidate); }
+};
+
+template <typename G, typename U>
+concept PropertyGenerator = requires(const G& generator, PropertyRng& rng, std::size_t size, U& out) {
+    generator.generate(rng, size, out);
+};
+
+template <typename G, typename U>
+concept ShrinkingGenerator = PropertyGenerator<G, U> && requires(const G& generator, const U& value, ShrinkSink<U> sink) {
+    { generator.shrink(value, sink) } -> std::convertible_to<bool>;
+};
+
+// Default generators, specialise for your own types or pass a generator explicitly
+template <typename U, typename Enable = void>
+struct Arbitrary;
+
+template <typename U>
+struct Arbitrary<U, std::enable_if_t<std::is_integral_v<U> && !std::is_same_v<U, bool>>> {
+    void generate(PropertyRng& rng, std::size_t size, U& out) const {
+        using Limits = std::numeric_limits<U>;
+        if (rng.chance(16)) {
+            // Edge values find overflow and sign bugs that small values never reach
+            const U edges[] = { U(0), U(1), Limits::max(), Limits::min(), static_cast<U>(Limits::max() / 2 + 1), static_cast<U>(Limits::min() + 1) };
+            out = edges[rng.below(sizeof(edges) / sizeof(edges[0]))];
+        }
+        else if (rng.chance(8)) {
+            out = static_cast<U>(rng.next());
+        }
+        else {
+            // Small magnitudes that grow with size
+            const std::uint64_t span = std::min<std::uint64_t>(size, static_cast<std::uint64_t>(Limits::max()));
+            U magnitude = static_cast<U>(rng.below(span + 1));
+            if constexpr (std::is_signed_v<U>) {
+                out = rng.chance(2) ? static_cast<U>(-magnitude) : magnitude;
+            }
+            else {
+                out = magnitude;
+            }
+        }
+    }
+
+    // Towards zero: 0, then value - value/2, value - value/4, ..., value - 1
+    bool shrink(const U& value, ShrinkSink<U> sink) const {
+        if (value == U(0)) {
+            return false;
+        }
+        if (sink(U(0))) {
+            return true;
+        }
+        if constexpr (std::is_signed_v<U>) {
+            if (value < U(0) && value != std::numeric_limits<U>::min() && sink(static_cast<U>(-value))) {
+                return true;
+            }
+        }
+        for (U delta = static_cast<U>(value / 2); delta != U(0); delta = static_cast<U>(delta / 2)) {
+            if (sink(static_cast<U>(value - delta))) {
+                return true;
+            }
+        }
+        return sink(static_cast<U>(value < U(0) ? value + 1 : value - 1));
+    }
+};
+
+template <typename U>
+struct Arbitrary<U, std::enable_if_t<std::is_floating_point_v<U>>> {
+    void generate(PropertyRng& rng, std::size_t size, U& out) const {
+        using Limits = std::numeric_limits<U>;
+        if (rng.chance(16)) {
+            const U edges[] = { U(0), U(-0.0), U(1), U(-1), Limits::min(), Limits::max(), Limits::lowest(), Limits::epsilon(), Limits::denorm_min() };
+            out = edges[rng.below(sizeof(edges) / sizeof(edges[0]))];
+        }
+        else {
+            out = static_cast<U>((rng.unit() * 2.0 - 1.0) * static_cast<double>(size + 1));
+        }
+    }
+
+    // 0, the integer part, half the value
+    bool shrink(const U& value, ShrinkSink<U> sink) const {
+        if (value == U(0) || !std::isfinite(value)) {
+            return false;
+        }
+        if (sink(U(0))) {
+            return true;
+        }
+        const U whole = std::trunc(value);
+        if (whole != value && sink(whole)) {
+            return true;
+        }
+        const U half = value / 2;
+        return half != value && std::abs(half) < std::abs(value) && sink(half);
+    }
+};
+
+template <>
+struct Arbitrary<bool> {
+    void generate(PropertyRng& rng, std::size_t, bool& out) const { out = rng.chance(2); }
+    bool shrink(const bool& value, ShrinkSink<bool> sink) const { return value && sink(false); }
+};
+
+namespace cpptf_property_detail {
+    // Shrinks of a sequence: drop halves, quarters, ... down to single elements, then shrink one element
+    template <typename Sequence, typename ElementGenerator>
+    bool shrinkSequence(const Sequence& value, ShrinkSink<Sequence> sink, const ElementGenerator& elements) {
+        using Element = typename Sequence::value_type;
+        const std::size_t length = value.size();
+        Sequence candidate;
+        candidate.reserve(length);
+        for (std::size_t chunk = length; chunk > 0; chunk /= 2) {
+            for (std::size_t start = 0; start + chunk <= length; start += chunk) {
+                candidate.assign(value.begin(), value.begin() + start);
+                candidate.insert(candidate.end(), value.begin() + start + chunk, value.end());
+                if (sink(candidate)) {
+                    return true;
+                }
+            }
+        }
+        if constexpr (ShrinkingGenerator<ElementGenerator, Element>) {
+            for (std::size_t i = 0; i < length; ++i) {
+                struct Context {
+                    const Sequence* whole;
+                    Sequence* candidate;
+                    std::size_t position;
+                    ShrinkSink<Sequence> outer;
+                } context{ &value, &candidate, i, sink };
+                ShrinkSink<Element> elementSink{ [](void* bound, const Element& element) {
+                    Context& c = *static_cast<Context*>(bound);
+                    *c.candidate = *c.whole;
+                    (*c.candidate)[c.position] = element;
+                    return c.outer(*c.candidate);
+                    }, &context };
+                if (elements.shrink(value[i], elementSink)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    template <typename U>
+    constexpr bool isStreamable = requires(std::ostream & os, const U & value) { os << value; };
+
+    // Counterexample formatting: streamable values as they are, strings quoted, ranges element by element
+    template <typename U>
+    void printValue(std::ostream& os, const U& value) {
+        if constexpr (std::is_same_v<U, std::string>) {
+            os << '"' << value << '"';
+        }
+        else if constexpr (std::is_same_v<U, bool>) {
+            os << (value ? "true" : "false");
+        }
+        else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) {
+            os << static_cast<int>(value);
+        }
+        else if constexpr (isStreamable<U>) {
+            os << value;
+        }
+        else if constexpr (requires { value.begin(); value.end(); value.size(); }) {
+            constexpr std::size_t maxShown = 32;
+            os << '[';
+            std::size_t shown = 0;
+            for (const auto& element : value) {
+                if (shown == maxShown) {
+                    os << ", ... (" << value.size() << " elements)";
+                    break;
+                }
+                os << (shown++ == 0 ? "" : ", ");
+                printValue(os, element);
+            }
+            os << ']';
+        }
+        else {
+            os << "<value of " << sizeof(U) << " bytes>";
+        }
+    }
+}
+
+template <typename U>
+struct Arbitrary<std::vector<U>> {
+    Arbitrary<U> elements;
+
+    void generate(PropertyRng& rng, std::size_t size, std::vector<U>& out) const {
+        out.resize(rng.below(size + 1));  // keeps the capacity of the previous case
+        for (auto&& element : out) {
+            if constexpr (std::is_same_v<U, bool>) {
+                bool value;
+                elements.generate(rng, size, value);
+                element = value;
+            }
+            else {
+                elements.generate(rng, size, element);
+            }
+        }
+    }
+
+    bool shrink(const std::vector<U>& value, ShrinkSink<std::vector<U>> sink) const {
+        return cpptf_property_detail::shrinkSequence(value, sink, elements);
+    }
+};
+
+// Printable ASCII strings
+template <>
+struct Arbitrary<std::string> {
+    struct Characters {
+        void generate(PropertyRng& rng, std::size_t, char& out) const { out = static_cast<char>(' ' + rng.below(95)); }
+        bool shrink(const char& value, ShrinkSink<char> sink) const { return value != 'a' && sink('a'); }
+    } characters;
+
+    void generate(PropertyRng& rng, std::size_t size, std::string& out) const {
+        out.resize(rng.below(size + 1));
+        for (char& c : out) {
+            characters.generate(rng, size, c);
+        }
+    }
+
+    bool shrink(const std::string& value, ShrinkSink<std::string> sink) const {
+        return cpptf_property_detail::shrinkSequence(value, sink, characters);
+    }
+};
+
+struct PropertyOptions {
+    std::size_t cases = 1000;
+    std::uint64_t seed = 0;             // 0 = pick a fresh seed, reported with the result
+    std::size_t maxSize = 100;          // case i is generated with size i % (maxSize + 1)
+    std::size_t workerCount = 0;        // 0 = hardware concurrency, 1 = run on the calling thread
+    std::size_t batchSize = 4096;       // cases per parallel work item
+    std::size_t maxShrinkSteps = 1000;  // accepted shrinks before giving up on a smaller counterexample
+    std::size_t replayCase = static_cast<std::size_t>(-1);  // run only this case of seed (from a failure report)
+};
+
+template <typename U>
+struct PropertyResult {
+    bool passed = true;
+    std::uint64_t seed = 0;
+    std::size_t casesRun = 0;
+    std::size_t failingCase = static_cast<std::size_t>(-1);
+    std::size_t shrinkSteps = 0;
+    std::unique_ptr<U> original;        // generated input that failed
+    std::unique_ptr<U> counterexample;  // after shrinking
+    std::string exception;              // what() when the property threw on the counterexample
+};
+
+namespace cpptf_property_detail {
+    inline std::uint64_t freshSeed() {
+        static std::atomic<std::uint64_t> counter{ 0 };
+        std::uint64_t x = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())
+            ^ (counter.fetch_add(1, std::memory_order_relaxed) << 32);
+        std::uint64_t seed = PropertyRng::splitmix(x);
+        return seed != 0 ? seed : 1;
+    }
+
+    // Property outcome of one input, an exception counts as a failure
+    template <typename U, typename Property>
+    bool holds(Property& property, const U& value, std::string* exception = nullptr) {
+        try {
+            return static_cast<bool>(property(value));
+        }
+        catch (const std::exception& error) {
+            if (exception != nullptr) *exception = error.what();
+        }
+        catch (...) {
+            if (exception != nullptr) *exception = "unknown exception";
+        }
+        return false;
+    }
+}
+
+// Run property over options.cases generated inputs and shrink the first failing one.
+// property is called concurrently from the pool's workers, see the note at the top.
+// "First" is the lowest failing case index, whatever the worker count, so the reported case is reproducible.
+template <typename U, typename Property, typename Generator = Arbitrary<U>>
+    requires PropertyGenerator<Generator, U>
+PropertyResult<U> checkProperty(Property&& property, const PropertyOptions& options = {}, const Generator& generator = {}) {
+    constexpr std::size_t none = static_cast<std::size_t>(-1);
+    PropertyResult<U> result;
+    result.seed = options.seed != 0 ? options.seed : cpptf_property_detail::freshSeed();
+
+    auto generateCase = [&](std::size_t caseIndex, U& out) {
+        PropertyRng rng = PropertyRng::forCase(result.seed, caseIndex);
+        generator.generate(rng, caseIndex % (options.maxSize + 1), out);
+    };
+
+    std::atomic<std::size_t> firstFailure{ none };
+    if (options.replayCase != none) {
+        U value{};
+        generateCase(options.replayCase, value);
+        result.casesRun = 1;
+        if (!cpptf_property_detail::holds(property, value)) {
+            firstFailure.store(options.replayCase);
+        }
+    }
+    else {
+        const std::size_t batchSize = std::max<std::size_t>(options.batchSize, 1);
+        const std::size_t batches = (options.cases + batchSize - 1) / batchSize;
+        std::atomic<std::size_t> casesRun{ 0 };
+
+        // One input buffer per worker, refilled in place case after case
+        auto runBatch = [&](std::size_t batch, U& value) {
+            const std::size_t begin = batch * batchSize;
+            const std::size_t end = std::min(begin + batchSize, options.cases);
+            std::size_t run = 0;
+            for (std::size_t i = begin; i < end && i < firstFailure.load(std::memory_order_relaxed); ++i) {
+                generateCase(i, value);
+                ++run;
+                if (!cpptf_property_detail::holds(property, value)) {
+                    std::size_t current = firstFailure.load(std::memory_order_relaxed);
+                    while (i < current && !firstFailure.compare_exchange_weak(current, i, std::memory_order_relaxed)) {
+                    }
+                    break;
+                }
+            }
+            casesRun.fetch_add(run, std::memory_order_relaxed);
+        };
+
+        if (options.workerCount == 1 || batches <= 1) {
+            U value{};
+            for (std::size_t batch = 0; batch < batches && firstFailure.load() == none; ++batch) {
+                runBatch(batch, value);
+            }
+        }
+        else {
+            ThreadPool pool(options.workerCount);
+            std::vector<U> buffers(pool.size());
+            pool.parallelFor(batches, [&](std::size_t batch, std::size_t worker) {
+                if (batch * batchSize < firstFailure.load(std::memory_order_relaxed)) {
+                    runBatch(batch, buffers[worker]);
+                }
+                }, 1);
+        }
+        result.casesRun = casesRun.load();
+    }
+
+    result.failingCase = firstFailure.load();
+    if (result.failingCase == none) {
+        return result;
+    }
+
+    // Shrink on the calling thread: keep the first candidate that still fails, start again from it
+    result.passed = false;
+    result.original = std::make_unique<U>();
+    generateCase(result.failingCase, *result.original);
+    result.counterexample = std::make_unique<U>(*result.original);
+
+    if constexpr (ShrinkingGenerator<Generator, U>) {
+        struct Context {
+            std::remove_reference_t<Property>* property;
+            U* accepted;
+        } context{ &property, result.counterexample.get() };
+        ShrinkSink<U> sink{ [](void* bound, const U& candidate) {
+            Context& c = *static_cast<Context*>(bound);
+            if (cpptf_property_detail::holds(*c.property, candidate)) {
+                return false;
+            }
+            *c.accepted = candidate;
+            return true;
+            }, &context };
+
+        while (result.shrinkSteps < options.maxShrinkSteps) {
+            const U current = *result.counterexample;
+            if (!generator.shrink(current, sink)) {
+                break;
+            }
+            ++result.shrinkSteps;
+        }
+    }
+    cpptf_property_detail::holds(property, *result.counterexample, &result.exception);
+    return result;
+}
+
+// "falsified after N cases (seed 0x..., case #k), shrunk in S steps: <value>"
+template <typename U>
+void describePropertyResult(std::ostream& os, const PropertyResult<U>& result) {
+    const auto flags = os.flags();
+    if (result.passed) {
+        os << "held for " << result.casesRun << " cases (seed 0x" << std::hex << result.seed << ')';
+        os.flags(flags);
+        return;
+    }
+    os << "falsified after " << result.casesRun << " cases (seed 0x" << std::hex << result.seed << std::dec
+        << ", case #" << result.failingCase << "), shrunk in " << result.shrinkSteps << " steps: ";
+    os.flags(flags);
+    cpptf_property_detail::printValue(os, *result.counterexample);
+    if (result.shrinkSteps > 0) {
+        os << " (generated: ";
+        cpptf_property_detail::printValue(os, *result.original);
+        os << ')';
+    }
+    if (!result.exception.empty()) {
+        os << ", threw: " << result.exception;
+    }
+}
@@ -0,0 +1,38 @@
+// AutoRegistration.cpp : copying the self-registered tests into the registry.
+//
+
+#include "AutoRegistration.h"
+
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+
+std::vector<const AutoTest*> AutoTests::list() {
+    std::vector<const AutoTest*> tests;
+    tests.reserve(count);
+    for (const AutoTest* test = head; test != nullptr; test = test->next) {
+        tests.push_back(test);
+    }
+    std::sort(tests.begin(), tests.end(), [](const AutoTest* a, const AutoTest* b) {
+        const int byFile = std::strcmp(a->file, b->file);
+        return byFile != 0 ? byFile < 0 : a->line < b->line;
+        });
+    return tests;
+}
+
+std::size_t AutoTests::registerAll(TestRegistry& registry) {
+    const std::vector<const AutoTest*> tests = list();
+    for (const AutoTest* test : tests) {
+        registry.add({ &AutoTests::invoke, const_cast<AutoTest*>(test), 0, test->suite, test->serial, "test", test->name, test->tags });
+    }
+    return tests.size();
+}
+
+int runAutoTests(const RegistryRunOptions& options) {
+    TestRegistry& registry = TestRegistry::getInstance();
+    AutoTests::registerAll(registry);
+    const TestSummary summary = registry.runAll(options);
+    std::cout << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+    return summary.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include<cstddef>
+#include<vector>
+#include "TestRegistry.h"
+
+// Self-registering tests.
+//
+//     CPPTF_TEST(Math, addition) {
+//         return UnitTest<int>::getInstance().assertEqual(1 + 1, 2);
+//     }
+//
+// Each test is one constant-initialized AutoTest node with internal linkage. The only code that runs
+// before main() is a pointer push onto an intrusive list whose head is itself constant-initialized, so
+// there is no static initialization order hazard between translation units and no heap allocation per
+// test. AutoTests::registerAll() copies the list into TestRegistry, where filters, sharding and the
+// parallel runner see the tests as "Suite::name" entries.
+//
+// TEST / TEST_TAGGED / SERIAL_TEST are defined as short aliases unless CPPTF_NO_SHORT_MACROS is defined.
+
+struct AutoTest {
+    const char* suite;
+    const char* name;
+    const char* tags;   // comma separated, may be null
+    const char* file;
+    int line;
+    bool serial;
+    bool (*body)();
+    AutoTest* next = nullptr;
+};
+
+class AutoTests {
+private:
+    static inline constinit AutoTest* head = nullptr;
+    static inline constinit std::size_t count = 0;
+
+    static bool invoke(void* test, std::size_t) { return static_cast<const AutoTest*>(test)->body(); }
+
+public:
+    // Static object next to every test node; its constructor only links the node
+    struct Link {
+        explicit Link(AutoTest& test) noexcept {
+            test.next = head;
+            head = &test;
+            ++count;
+        }
+    };
+
+    static std::size_t size() { return count; }
+
+    // Every linked test in source order (by file, then line)
+    static std::vector<const AutoTest*> list();
+
+    // Add every linked test to registry, returns how many were added.
+    // Call it once per registry contents: after TestRegistry::clear() it can be called again.
+    static std::size_t registerAll(TestRegistry& registry = TestRegistry::getInstance());
+};
+
+// Register every self-registered test and run the registry; exit code 0 when nothing failed
+int runAutoTests(const RegistryRunOptions& options = {});
+
+#define CPPTF_TEST_IMPL_(suite, name, tags, serial) \
+    static bool cpptf_test_##suite##_##name(); \
+    static constinit AutoTest cpptf_node_##suite##_##name{ #suite, #name, tags, __FILE__, __LINE__, serial, &cpptf_test_##suite##_##name }; \
+    static const AutoTests::Link cpptf_link_##suite##_##name{ cpptf_node_##suite##_##name }; \
+    static bool cpptf_test_##suite##_##name()
+
+// The body returns whether the test passed, like the callables given to addAssertion
+#define CPPTF_TEST(suite, name) CPPTF_TEST_IMPL_(suite, name, nullptr, false)
+#define CPPTF_TEST_TAGGED(suite, name, tags) CPPTF_TEST_IMPL_(suite, name, tags, false)
+#define CPPTF_SERIAL_TEST(suite, name) CPPTF_TEST_IMPL_(suite, name, nullptr, true)
+
+// A main() that runs every self-registered test of the program
+#define CPPTF_DEFINE_MAIN() \
+    int main() { return runAutoTests(); }
+
+#ifndef CPPTF_NO_SHORT_MACROS
+#define TEST(suite, name) CPPTF_TEST(suite, name)
+#define TEST_TAGGED(suite, name, tags) CPPTF_TEST_TAGGED(suite, name, tags)
+#define SERIAL_TEST(suite, name) CPPTF_SERIAL_TEST(suite, name)
+#endif
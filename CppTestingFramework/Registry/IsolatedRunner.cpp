@@ -0,0 +1,358 @@
+// IsolatedRunner.cpp : forked workers, the pipe protocol and crash / timeout recovery.
+//
+
+#include "IsolatedRunner.h"
+#include "../Watchdog/Watchdog.h"
+
+#include <thread>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+
+
+#ifdef CPPTF_HAS_FORK
+
+void IsolatedRunner::workerMain(int commandFd, int resultFd) {
+    ForwardingReporter forwarder(resultFd, Reporter::current());
+    Reporter::setCurrent(&forwarder);
+    const std::vector<TestEntry>& table = registry.entries();
+
+    std::vector<std::uint32_t> shard;
+    std::uint32_t count = 0;
+    while (readAll(commandFd, &count, sizeof(count)) && count > 0) {
+        shard.resize(count);
+        if (!readAll(commandFd, shard.data(), count * sizeof(std::uint32_t))) {
+            break;
+        }
+        for (std::uint32_t index : shard) {
+            const TestEntry& entry = table[index];
+            forwarder.entry = index;
+            bool passed = false;
+            try {
+                passed = registry.runEntry(index);
+            }
+            catch (const std::exception& error) {
+                forwarder.send(MessageKind::Assertion, false, entry.suiteName, "exception", std::string("threw: ") + error.what());
+            }
+            catch (...) {
+                forwarder.send(MessageKind::Assertion, false, entry.suiteName, "exception", "threw a non-std exception");
+            }
+            forwarder.send(MessageKind::Done, passed, "", "", "");
+        }
+    }
+
+    // _exit: the parent's static objects (open reporters, files) must not be torn down twice
+    std::cout.flush();
+    std::fflush(nullptr);
+    ::_exit(0);
+}
+
+void IsolatedRunner::spawn(Worker& worker, std::vector<Worker>& workers) {
+    int command[2];
+    int result[2];
+    if (::pipe(command) != 0) {
+        throw std::runtime_error("IsolatedRunner: pipe() failed");
+    }
+    if (::pipe(result) != 0) {
+        ::close(command[0]);
+        ::close(command[1]);
+        throw std::runtime_error("IsolatedRunner: pipe() failed");
+    }
+
+    // Anything still buffered would otherwise be written by the child as well
+    Reporter::current().flush();
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        for (int fd : { command[0], command[1], result[0], result[1] }) ::close(fd);
+        throw std::runtime_error("IsolatedRunner: fork() failed");
+    }
+    if (pid == 0) {
+        // A copy of another worker's result pipe here would hide that worker's crash from the parent
+        for (const Worker& other : workers) {
+            if (other.commandFd >= 0) ::close(other.commandFd);
+            if (other.resultFd >= 0) ::close(other.resultFd);
+        }
+        ::close(command[1]);
+        ::close(result[0]);
+        workerMain(command[0], result[1]);
+    }
+
+    ::close(command[0]);
+    ::close(result[1]);
+    worker = Worker{};
+    worker.pid = pid;
+    worker.commandFd = command[1];
+    worker.resultFd = result[0];
+}
+
+bool IsolatedRunner::sendShard(Worker& worker, std::deque<std::uint32_t>& pending, std::size_t batchSize, std::chrono::milliseconds timeout) {
+    const std::size_t count = std::min(batchSize, pending.size());
+    worker.shard.assign(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+    worker.finished = 0;
+
+    const std::uint32_t header = static_cast<std::uint32_t>(count);
+    if (!writeAll(worker.commandFd, &header, sizeof(header))
+        || !writeAll(worker.commandFd, worker.shard.data(), count * sizeof(std::uint32_t))) {
+        // Worker is already gone; reap() sees nothing started
+        worker.shard.clear();
+        return false;
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+    worker.started = std::chrono::steady_clock::now();
+    worker.deadline = worker.started + timeout;
+    return true;
+}
+
+void IsolatedRunner::finishEntry(Worker& worker, std::uint32_t position, bool passed, std::chrono::steady_clock::time_point now) {
+    failedAt[position] = passed ? 0 : 1;
+    elapsedAt[position] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - worker.started).count();
+}
+
+void IsolatedRunner::consume(Worker& worker, TestSummary& summary, Reporter& reporter, std::chrono::milliseconds timeout) {
+    std::size_t offset = 0;
+    while (worker.inbox.size() - offset >= sizeof(MessageHeader)) {
+        MessageHeader header;
+        std::memcpy(&header, worker.inbox.data() + offset, sizeof(header));
+        const std::size_t total = sizeof(header) + header.suiteLength + header.functionLength + header.textLength;
+        if (worker.inbox.size() - offset < total) {
+            break;
+        }
+
+        const char* payload = worker.inbox.data() + offset + sizeof(header);
+        if (header.kind == MessageKind::Assertion) {
+            std::string_view suite(payload, header.suiteLength);
+            std::string_view function(payload + header.suiteLength, header.functionLength);
+            std::string_view text(payload + header.suiteLength + header.functionLength, header.textLength);
+            const bool passed = header.passed != 0;
+            if (reporter.wants(passed)) {
+                // The worker ran the entry under its key; the parent names the result the same way
+                const std::string_view test = registry.keyOf(header.entry);
+                reporter.report({ passed, suite, function, &IsolatedRunner::describeText, &text, test });
+            }
+        }
+        else if (header.kind == MessageKind::Done && worker.finished < worker.shard.size()) {
+            const auto now = std::chrono::steady_clock::now();
+            summary.record(header.passed != 0);
+            finishEntry(worker, worker.shard[worker.finished], header.passed != 0, now);
+            ++worker.finished;
+            worker.started = now;
+            worker.deadline = now + timeout;
+            if (worker.finished == worker.shard.size()) {
+                worker.shard.clear();
+                worker.finished = 0;
+            }
+        }
+        offset += total;
+    }
+    worker.inbox.erase(0, offset);
+}
+
+void IsolatedRunner::reap(Worker& worker, std::deque<std::uint32_t>& pending, TestSummary& summary, Reporter& reporter, bool timedOut) {
+    if (timedOut) {
+        ::kill(worker.pid, SIGKILL);
+    }
+    if (worker.commandFd >= 0) ::close(worker.commandFd);
+    ::close(worker.resultFd);
+    int status = 0;
+    while (::waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {}
+
+    if (worker.finished < worker.shard.size()) {
+        LostEntry lost{ &registry.entries()[worker.shard[worker.finished]], worker.shard[worker.finished], {} };
+        if (timedOut) {
+            lost.reason = "timed out";
+            ++timeoutCount;
+        }
+        else {
+            if (WIFSIGNALED(status)) {
+                lost.reason = std::string("crashed (signal ") + std::to_string(WTERMSIG(status)) + ": " + ::strsignal(WTERMSIG(status)) + ")";
+            }
+            else if (WEXITSTATUS(status) == Watchdog::hangExitCode) {
+                lost.reason = "hung, ended by the watchdog (exit code " + std::to_string(Watchdog::hangExitCode) + ")";
+            }
+            else {
+                lost.reason = "ended its worker (exit code " + std::to_string(WEXITSTATUS(status)) + ")";
+            }
+            ++crashCount;
+        }
+        summary.record(false);
+        finishEntry(worker, lost.index, false, std::chrono::steady_clock::now());
+        const std::string_view test = registry.keyOf(lost.index);
+        reporter.report({ false, lost.entry->suiteName, "IsolatedRunner", &IsolatedRunner::describeLost, &lost, test });
+
+        // The rest of the shard never ran: give it to the next worker first
+        pending.insert(pending.begin(), worker.shard.begin() + static_cast<std::ptrdiff_t>(worker.finished) + 1, worker.shard.end());
+    }
+    worker = Worker{};
+}
+
+void IsolatedRunner::runPhase(std::deque<std::uint32_t> pending, std::size_t workerCount, std::size_t batchSize,
+    std::chrono::milliseconds timeout, TestSummary& summary, Reporter& reporter) {
+    if (pending.empty()) {
+        return;
+    }
+    if (batchSize == 0) {
+        // Several shards per worker so a slow shard does not hold up the end of the run
+        batchSize = std::clamp<std::size_t>(pending.size() / (workerCount * 8), 1, 256);
+    }
+    const bool limited = timeout.count() > 0;
+
+    std::vector<Worker> workers(std::min(workerCount, pending.size()));
+    std::vector<pollfd> polled;
+    std::vector<Worker*> polledWorkers;
+    char buffer[64 * 1024];
+
+    while (true) {
+        std::size_t alive = 0;
+        for (Worker& worker : workers) {
+            if (worker.pid < 0 && !pending.empty()) {
+                spawn(worker, workers);
+            }
+            if (worker.pid < 0) {
+                continue;
+            }
+            if (worker.shard.empty() && !worker.retiring) {
+                if (!pending.empty()) {
+                    sendShard(worker, pending, batchSize, timeout);
+                }
+                else {
+                    // Count 0 tells the worker to exit; its end of file is picked up by poll()
+                    const std::uint32_t stop = 0;
+                    writeAll(worker.commandFd, &stop, sizeof(stop));
+                    ::close(worker.commandFd);
+                    worker.commandFd = -1;
+                    worker.retiring = true;
+                }
+            }
+            ++alive;
+        }
+        if (alive == 0) {
+            break;
+        }
+
+        polled.clear();
+        polledWorkers.clear();
+        auto nearest = std::chrono::steady_clock::time_point::max();
+        for (Worker& worker : workers) {
+            if (worker.pid >= 0) {
+                polled.push_back({ worker.resultFd, POLLIN, 0 });
+                polledWorkers.push_back(&worker);
+                if (limited && !worker.shard.empty()) {
+                    nearest = std::min(nearest, worker.deadline);
+                }
+            }
+        }
+
+        int waitMs = -1;
+        if (nearest != std::chrono::steady_clock::time_point::max()) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(nearest - std::chrono::steady_clock::now()).count();
+            waitMs = static_cast<int>(std::clamp<long long>(left + 1, 0, 60 * 1000));
+        }
+        if (::poll(polled.data(), static_cast<nfds_t>(polled.size()), waitMs) < 0 && errno != EINTR) {
+            throw std::runtime_error("IsolatedRunner: poll() failed");
+        }
+
+        for (std::size_t i = 0; i < polled.size(); ++i) {
+            Worker& worker = *polledWorkers[i];
+            if (polled[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                ssize_t got = ::read(worker.resultFd, buffer, sizeof(buffer));
+                if (got > 0) {
+                    worker.inbox.append(buffer, static_cast<std::size_t>(got));
+                    consume(worker, summary, reporter, timeout);
+                    continue;
+                }
+                if (got < 0 && errno == EINTR) {
+                    continue;
+                }
+                reap(worker, pending, summary, reporter, false);
+            }
+        }
+
+        // Every worker, every round: one that keeps writing without finishing its entry is never idle in poll()
+        if (limited) {
+            const auto now = std::chrono::steady_clock::now();
+            for (Worker& worker : workers) {
+                if (worker.pid >= 0 && !worker.shard.empty() && now >= worker.deadline) {
+                    reap(worker, pending, summary, reporter, true);
+                }
+            }
+        }
+    }
+}
+
+TestSummary IsolatedRunner::run(const IsolatedRunOptions& options) {
+    if (ThreadPool::runningWorkers() > 0 || Watchdog::getInstance().isWatching()) {
+        throw std::logic_error("IsolatedRunner: cannot fork while ThreadPool workers or a guarded run are active");
+    }
+    crashCount = 0;
+    timeoutCount = 0;
+
+    std::size_t workerCount = options.workerCount;
+    if (workerCount == 0) {
+        workerCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    std::deque<std::uint32_t> parallel;
+    std::deque<std::uint32_t> serial;
+    const std::vector<TestEntry>& table = registry.entries();
+    const std::vector<std::uint32_t> selected = registry.select(options);
+    for (std::uint32_t position : selected) {
+        (table[position].serial ? serial : parallel).push_back(position);
+    }
+    failedAt.assign(table.size(), 0);
+    elapsedAt.assign(table.size(), 0);
+
+    Reporter& reporter = Reporter::current();
+    reporter.beginRun();
+
+    // A worker that dies between reads must not take the parent down with SIGPIPE
+    struct sigaction ignore {};
+    struct sigaction previous {};
+    ignore.sa_handler = SIG_IGN;
+    ::sigaction(SIGPIPE, &ignore, &previous);
+
+    TestSummary summary;
+    try {
+        runPhase(std::move(parallel), workerCount, options.batchSize, options.timeout, summary, reporter);
+        runPhase(std::move(serial), 1, options.batchSize, options.timeout, summary, reporter);
+    }
+    catch (...) {
+        ::sigaction(SIGPIPE, &previous, nullptr);
+        reporter.endRun(summary);
+        throw;
+    }
+    ::sigaction(SIGPIPE, &previous, nullptr);
+
+    reporter.endRun(summary);
+    if (!options.stateFile.empty()) {
+        std::vector<std::uint8_t> failed(selected.size());
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            failed[i] = failedAt[selected[i]];
+        }
+        registry.recordState(options, selected, failed);
+    }
+    if (!options.recordDurations.empty()) {
+        std::vector<std::int64_t> elapsed(selected.size());
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            elapsed[i] = elapsedAt[selected[i]];
+        }
+        registry.recordDurations(options, selected, elapsed);
+    }
+    return summary;
+}
+
+#else
+
+TestSummary IsolatedRunner::run(const IsolatedRunOptions& options) {
+    crashCount = 0;
+    timeoutCount = 0;
+    return registry.runAll(options);
+}
+
+#endif
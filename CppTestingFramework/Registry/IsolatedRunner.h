@@ -0,0 +1,174 @@
+#pragma once
+#include<vector>
+#include<deque>
+#include<string>
+#include<string_view>
+#include<chrono>
+#include<mutex>
+#include<cstdint>
+#include "TestRegistry.h"
+#include "../UnitTest/TestSummary.h"
+#include "../Reporter/Reporter.h"
+#include "../Reporter/ReportFormat.h"
+#include "../ThreadPool/ThreadPool.h"
+
+#if __has_include(<unistd.h>) && __has_include(<sys/wait.h>) && __has_include(<poll.h>)
+#include<unistd.h>
+#include<signal.h>
+#include<poll.h>
+#include<sys/wait.h>
+#define CPPTF_HAS_FORK 1
+#endif
+
+// Runs the TestRegistry table in forked worker processes, so an assertion that crashes or hangs only
+// costs its own result instead of the whole run.
+//
+// Every worker is a fork() of the test binary and therefore already holds the same table; the parent only
+// sends it shards of entry indices over a pipe. The worker streams every reported result plus a "done"
+// record per entry back over a second pipe, and the parent replays them into Reporter::current(), so the
+// reporters only ever run in one process.
+// When a worker dies the entry it was running is reported as crashed, the rest of its shard is queued
+// again and a replacement worker is forked. An entry that runs longer than the timeout gets its worker killed.
+// Serial entries run afterwards in a single worker.
+// Entries are picked by TestRegistry::select, so filters, onlyFailed and shards work as in runAll, and the
+// state and durations files are written the same way.
+//
+// fork() only copies the calling thread: run() refuses to start while a ThreadPool has live workers or a
+// timeout-guarded run is in progress, since a lock held by one of them would stay locked in every worker.
+//
+// Without fork() (Windows) run() falls back to TestRegistry::runAll in this process.
+
+// workerCount: 0 uses every hardware thread; batchSize: entries per shard, 0 picks one automatically
+struct IsolatedRunOptions : RegistryRunOptions {
+    std::chrono::milliseconds timeout{ 0 };    // per entry, 0 waits forever
+};
+
+class IsolatedRunner {
+private:
+    TestRegistry& registry;
+    std::size_t crashCount = 0;
+    std::size_t timeoutCount = 0;
+
+#ifdef CPPTF_HAS_FORK
+    enum class MessageKind : std::uint8_t { Assertion = 1, Done = 2 };
+
+    // Fixed part of every worker -> parent message, followed by suite, function and text bytes
+    struct MessageHeader {
+        std::uint32_t entry;
+        MessageKind kind;
+        std::uint8_t passed;
+        std::uint16_t reserved;
+        std::uint32_t suiteLength;
+        std::uint32_t functionLength;
+        std::uint32_t textLength;
+    };
+
+    struct Worker {
+        pid_t pid = -1;
+        int commandFd = -1;                  // parent -> worker: shards
+        int resultFd = -1;                   // worker -> parent: messages
+        std::vector<std::uint32_t> shard;    // entries sent, empty while idle
+        std::size_t finished = 0;            // entries of shard that reported "done"
+        std::chrono::steady_clock::time_point started;   // of the entry running now
+        std::chrono::steady_clock::time_point deadline;
+        std::string inbox;
+        bool retiring = false;               // told to exit, no more shards
+    };
+
+    // Reporter installed inside a worker: forwards every result to the parent
+    class ForwardingReporter : public Reporter {
+    private:
+        int fd;
+        const Reporter& target;
+        std::mutex writeMutex;
+
+    public:
+        std::uint32_t entry = 0;
+
+        ForwardingReporter(int fd, const Reporter& target) : fd(fd), target(target) {}
+
+        bool wants(bool passed) const override { return target.wants(passed); }
+
+        void report(const AssertionResult& result) override {
+            send(MessageKind::Assertion, result.passed, result.suiteName, result.functionName, describeToScratch(result));
+        }
+
+        void send(MessageKind kind, bool passed, std::string_view suite, std::string_view function, std::string_view text) {
+            MessageHeader header{ entry, kind, static_cast<std::uint8_t>(passed), 0,
+                static_cast<std::uint32_t>(suite.size()), static_cast<std::uint32_t>(function.size()), static_cast<std::uint32_t>(text.size()) };
+
+            std::lock_guard<std::mutex> lock(writeMutex);
+            writeAll(fd, &header, sizeof(header));
+            writeAll(fd, suite.data(), suite.size());
+            writeAll(fd, function.data(), function.size());
+            writeAll(fd, text.data(), text.size());
+        }
+    };
+
+    // Result the parent synthesises for an entry whose worker crashed or timed out
+    struct LostEntry {
+        const TestEntry* entry;
+        std::uint32_t index;
+        std::string reason;
+    };
+
+    static bool writeAll(int fd, const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    static bool readAll(int fd, void* data, std::size_t size) {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0) {
+            ssize_t got = ::read(fd, bytes, size);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            bytes += got;
+            size -= static_cast<std::size_t>(got);
+        }
+        return true;
+    }
+
+    static void describeText(std::ostream& os, const void* context) {
+        os << *static_cast<const std::string_view*>(context);
+    }
+
+    static void describeLost(std::ostream& os, const void* context) {
+        const LostEntry& lost = *static_cast<const LostEntry*>(context);
+        os << lost.entry->key << " " << lost.reason;  // the key, like the result label, not the table position
+    }
+
+    // Per table position, filled as entries finish; read back in selection order for the state files
+    std::vector<std::uint8_t> failedAt;
+    std::vector<std::int64_t> elapsedAt;
+
+    void finishEntry(Worker& worker, std::uint32_t position, bool passed, std::chrono::steady_clock::time_point now);
+    [[noreturn]] void workerMain(int commandFd, int resultFd);
+    void spawn(Worker& worker, std::vector<Worker>& workers);
+    bool sendShard(Worker& worker, std::deque<std::uint32_t>& pending, std::size_t batchSize, std::chrono::milliseconds timeout);
+    void consume(Worker& worker, TestSummary& summary, Reporter& reporter, std::chrono::milliseconds timeout);
+    void reap(Worker& worker, std::deque<std::uint32_t>& pending, TestSummary& summary, Reporter& reporter, bool timedOut);
+    void runPhase(std::deque<std::uint32_t> pending, std::size_t workerCount, std::size_t batchSize,
+        std::chrono::milliseconds timeout, TestSummary& summary, Reporter& reporter);
+#endif
+
+public:
+    explicit IsolatedRunner(TestRegistry& registry = TestRegistry::getInstance()) : registry(registry) {}
+
+    // Do not register or remove entries while this runs
+    TestSummary run(const IsolatedRunOptions& options = {});
+
+    // Entries of the last run that took their worker down / were killed for running too long.
+    // Both are also counted as failures in the returned summary.
+    std::size_t crashes() const { return crashCount; }
+    std::size_t timeouts() const { return timeoutCount; }
+};
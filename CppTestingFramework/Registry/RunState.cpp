@@ -0,0 +1,46 @@
+// RunState.cpp : reading and writing the last-run state file.
+//
+
+#include "RunState.h"
+
+#include <fstream>
+#include <cstdio>
+
+
+bool RunState::load(const std::string& path, std::unordered_set<std::string>& failed) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line.front() != '#') {
+            failed.insert(line);
+        }
+    }
+    return true;
+}
+
+bool RunState::save(const std::string& path, const std::unordered_set<std::string>& failed) {
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << "# CppTestingFramework: entries that failed in the last run\n";
+        for (const std::string& key : failed) {
+            file << key << '\n';
+        }
+        if (!file) {
+            return false;
+        }
+    }
+#if defined(_WIN32)
+    std::remove(path.c_str());  // rename fails there if path exists; elsewhere it replaces it atomically
+#endif
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include<string>
+#include<string_view>
+#include<vector>
+#include<unordered_set>
+
+// Small local state file that remembers which registry entries failed, so the next run can be
+// restricted to them (RegistryRunOptions::onlyFailed).
+// Plain text, one entry key per line ("suite::name" or "suite#kind:index"), '#' lines are comments.
+// It is written to a temporary file first and renamed, so an interrupted run never leaves half a file.
+class RunState {
+public:
+    static constexpr const char* defaultPath = ".cpptf_last_run";
+
+    // false when there is no state file yet
+    static bool load(const std::string& path, std::unordered_set<std::string>& failed);
+    static bool save(const std::string& path, const std::unordered_set<std::string>& failed);
+};
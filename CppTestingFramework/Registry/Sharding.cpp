@@ -0,0 +1,122 @@
+// Sharding.cpp : durations files and the shard assignment.
+//
+
+#include "Sharding.h"
+
+#include <map>
+#include <fstream>
+#include <charconv>
+#include <numeric>
+#include <algorithm>
+#include <cstdio>
+
+
+std::uint64_t shardHash(std::string_view key) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char ch : key) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool DurationHistory::load(const std::string& path, std::unordered_map<std::string, std::int64_t>& durations) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const std::size_t tab = line.rfind('\t');
+        if (line.empty() || line.front() == '#' || tab == std::string::npos) {
+            continue;
+        }
+        std::int64_t nanoseconds = 0;
+        const char* first = line.data() + tab + 1;
+        const char* last = line.data() + line.size();
+        auto [end, error] = std::from_chars(first, last, nanoseconds);
+        if (error == std::errc() && end == last) {
+            durations[line.substr(0, tab)] = nanoseconds;
+        }
+    }
+    return true;
+}
+
+bool DurationHistory::save(const std::string& path, const std::unordered_map<std::string, std::int64_t>& durations) {
+    const std::map<std::string, std::int64_t> sorted(durations.begin(), durations.end());
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << "# CppTestingFramework: wall time of each entry in nanoseconds\n";
+        for (const auto& [key, nanoseconds] : sorted) {
+            file << key << '\t' << nanoseconds << '\n';
+        }
+        if (!file) {
+            return false;
+        }
+    }
+#if defined(_WIN32)
+    std::remove(path.c_str());  // see RunState::save
+#endif
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+std::vector<std::uint32_t> assignShards(const std::vector<std::string>& keys, std::size_t shardCount,
+    const std::unordered_map<std::string, std::int64_t>* durations) {
+    std::vector<std::uint32_t> shards(keys.size(), 0);
+    if (shardCount <= 1) {
+        return shards;
+    }
+    std::vector<std::uint64_t> hashes(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        hashes[i] = shardHash(keys[i]);
+    }
+    if (durations == nullptr || durations->empty()) {
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            shards[i] = static_cast<std::uint32_t>(hashes[i] % shardCount);
+        }
+        return shards;
+    }
+
+    std::vector<std::int64_t> cost(keys.size(), -1);
+    std::vector<std::int64_t> known;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        auto found = durations->find(keys[i]);
+        if (found != durations->end()) {
+            cost[i] = std::max<std::int64_t>(found->second, 1);
+            known.push_back(cost[i]);
+        }
+    }
+    std::int64_t median = 1;
+    if (!known.empty()) {
+        std::nth_element(known.begin(), known.begin() + known.size() / 2, known.end());
+        median = known[known.size() / 2];
+    }
+    for (std::int64_t& value : cost) {
+        if (value < 0) {
+            value = median;
+        }
+    }
+
+    std::vector<std::size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        if (cost[a] != cost[b]) return cost[a] > cost[b];
+        if (hashes[a] != hashes[b]) return hashes[a] < hashes[b];
+        return keys[a] < keys[b];
+        });
+
+    std::vector<std::int64_t> load(shardCount, 0);
+    for (std::size_t i : order) {
+        const std::size_t lightest = static_cast<std::size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        shards[i] = static_cast<std::uint32_t>(lightest);
+        load[lightest] += cost[i];
+    }
+    return shards;
+}
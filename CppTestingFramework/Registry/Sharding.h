@@ -0,0 +1,32 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<unordered_map>
+
+// Splitting the registry table across CI machines (RegistryRunOptions::shardIndex / shardCount).
+//
+// Without history every entry goes to shard fnv1a(key) % shardCount: the same test always lands on the
+// same machine, whatever else was added, removed or filtered out.
+// With a durations file every machine computes the same longest-processing-time-first assignment:
+// entries sorted by recorded duration (longest first, ties by hash) are handed one by one to the
+// shard with the least total time so far. Entries without history count as the median recorded duration.
+// All shards of one run must read the same durations file, or they will disagree about the split.
+
+// FNV-1a of the key, the shard of an entry without recorded durations
+std::uint64_t shardHash(std::string_view key);
+
+// Per-entry wall time of previous runs, a plain text file of "key<TAB>nanoseconds" lines
+class DurationHistory {
+public:
+    // false when the file does not exist; existing keys are overwritten
+    static bool load(const std::string& path, std::unordered_map<std::string, std::int64_t>& durations);
+    // Sorted by key so the file diffs well; written to a temporary file and renamed
+    static bool save(const std::string& path, const std::unordered_map<std::string, std::int64_t>& durations);
+};
+
+// Shard of every key (same order as keys)
+std::vector<std::uint32_t> assignShards(const std::vector<std::string>& keys, std::size_t shardCount,
+    const std::unordered_map<std::string, std::int64_t>* durations);
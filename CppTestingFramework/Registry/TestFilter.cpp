@@ -0,0 +1,116 @@
+// TestFilter.cpp : glob matching and the filter syntax.
+//
+
+#include "TestFilter.h"
+
+
+bool globMatch(std::string_view pattern, std::string_view text) {
+    std::size_t p = 0;
+    std::size_t t = 0;
+    std::size_t starPattern = std::string_view::npos;
+    std::size_t starText = 0;
+
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        }
+        else if (p < pattern.size() && pattern[p] == '*') {
+            // Remember the star, first try to let it match nothing
+            starPattern = p++;
+            starText = t;
+        }
+        else if (starPattern != std::string_view::npos) {
+            // Let the last star swallow one more character
+            p = starPattern + 1;
+            t = ++starText;
+        }
+        else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool hasTag(std::string_view tags, std::string_view tag) {
+    while (!tags.empty()) {
+        std::size_t comma = tags.find(',');
+        if (tags.substr(0, comma) == tag) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        tags.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+TestFilter TestFilter::parse(std::string_view spec) {
+    TestFilter filter;
+    while (!spec.empty()) {
+        std::size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+
+        bool negative = !item.empty() && item.front() == '-';
+        if (negative) {
+            item.remove_prefix(1);
+        }
+        if (item.empty()) {
+            continue;
+        }
+        if (item.size() >= 2 && item.front() == '[' && item.back() == ']') {
+            (negative ? filter.excludeTags : filter.tags).emplace_back(item.substr(1, item.size() - 2));
+        }
+        else {
+            (negative ? filter.exclude : filter.include).emplace_back(item);
+        }
+    }
+    return filter;
+}
+
+bool TestFilter::matches(std::string_view key, std::string_view name, std::string_view entryTags) const {
+    auto matchesPattern = [key, name](const std::string& pattern) {
+        if (globMatch(pattern, key)) {
+            return true;
+        }
+        return !name.empty() && pattern.find("::") == std::string::npos && globMatch(pattern, name);
+    };
+
+    for (const std::string& pattern : exclude) {
+        if (matchesPattern(pattern)) {
+            return false;
+        }
+    }
+    for (const std::string& tag : excludeTags) {
+        if (hasTag(entryTags, tag)) {
+            return false;
+        }
+    }
+
+    if (!include.empty()) {
+        bool included = false;
+        for (const std::string& pattern : include) {
+            if (matchesPattern(pattern)) {
+                included = true;
+                break;
+            }
+        }
+        if (!included) {
+            return false;
+        }
+    }
+    if (!tags.empty()) {
+        for (const std::string& tag : tags) {
+            if (hasTag(entryTags, tag)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return true;
+}
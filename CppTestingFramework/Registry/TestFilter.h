@@ -0,0 +1,35 @@
+#pragma once
+#include<string>
+#include<string_view>
+#include<vector>
+#include<cstddef>
+
+// Selects registry entries by name and tag.
+//
+// Every entry is matched under its key: "suite::name" for named assertions (addNamedAssertion), or
+// "suite#kind:index" for unnamed ones ("i#serial:0" is the first addSerialAssertion of UnitTest<int>).
+// A pattern without "::" is also tried against the bare name. Patterns are globs: '*' matches any run of characters, '?' one character.
+//
+// TestFilter::parse takes the comma separated form used on command lines:
+//     "i::assert*,-*Slow*,[fast],-[flaky]"
+// plain items include, '-' items exclude, [tag] items select by tag.
+
+// Glob match of the whole text, '*' and '?' wildcards
+bool globMatch(std::string_view pattern, std::string_view text);
+
+// Does the comma separated tag list contain tag?
+bool hasTag(std::string_view tags, std::string_view tag);
+
+struct TestFilter {
+    std::vector<std::string> include;       // key globs, empty = every entry
+    std::vector<std::string> exclude;
+    std::vector<std::string> tags;          // entry needs one of these, empty = no restriction
+    std::vector<std::string> excludeTags;
+
+    bool empty() const { return include.empty() && exclude.empty() && tags.empty() && excludeTags.empty(); }
+
+    static TestFilter parse(std::string_view spec);
+
+    // key is "suite::name" or "suite#kind:index", name may be empty
+    bool matches(std::string_view key, std::string_view name, std::string_view entryTags) const;
+};
@@ -0,0 +1,253 @@
+// TestRegistry.cpp : the registry table, entry selection and the parallel run.
+//
+
+#include "TestRegistry.h"
+
+
+TestRegistry& TestRegistry::getInstance() {
+    static TestRegistry registry;
+    return registry;
+}
+
+std::size_t TestRegistry::add(const TestEntry& entry) {
+    std::string key = entry.suiteName;
+    if (entry.name != nullptr) {
+        key += "::";
+        key += entry.name;
+    }
+    else {
+        key += '#';
+        key += entry.kind;
+        key += ':';
+        key += std::to_string(entry.index);
+    }
+
+    std::lock_guard<std::mutex> lock(registrationMutex);
+    table.push_back(entry);
+    table.back().key = strings.emplace_back(std::move(key)).c_str();
+    return table.size() - 1;
+}
+
+void TestRegistry::clear() {
+    std::lock_guard<std::mutex> lock(registrationMutex);
+    table.clear();
+    strings.clear();
+    sequences.clear();
+}
+
+void TestRegistry::removeEntries(bool (*invoke)(void* suite, std::size_t index), const void* suite) {
+    std::lock_guard<std::mutex> lock(registrationMutex);
+    table.erase(std::remove_if(table.begin(), table.end(), [invoke, suite](const TestEntry& entry) {
+        return entry.invoke == invoke && entry.suite == suite;
+        }), table.end());
+}
+
+std::size_t TestRegistry::nextSequence(std::string_view suiteName, std::string_view kind) {
+    std::string key(suiteName);
+    key += '#';
+    key += kind;
+    std::lock_guard<std::mutex> lock(registrationMutex);
+    return sequences[key]++;
+}
+
+const char* TestRegistry::intern(std::string_view text) {
+    std::lock_guard<std::mutex> lock(registrationMutex);
+    return strings.emplace_back(text).c_str();
+}
+
+std::vector<std::uint32_t> TestRegistry::select(const RegistryRunOptions& options) const {
+    std::unordered_set<std::string> lastFailed;
+    const bool onlyFailed = options.onlyFailed && !options.stateFile.empty() && RunState::load(options.stateFile, lastFailed);
+
+    std::vector<std::uint32_t> selected;
+    selected.reserve(table.size());
+    if (options.filter.empty() && !onlyFailed) {
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            selected.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    else {
+        std::string failedKey;  // reused: the state set is looked up by std::string
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            const std::string_view key = keyOf(i);
+            if (onlyFailed && lastFailed.count(failedKey.assign(key)) == 0) {
+                continue;
+            }
+            const TestEntry& entry = table[i];
+            if (options.filter.matches(key, entry.name != nullptr ? entry.name : "", entry.tags != nullptr ? entry.tags : "")) {
+                selected.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    if (options.shardCount > 1) {
+        std::vector<std::string> keys;
+        keys.reserve(selected.size());
+        for (std::uint32_t position : selected) {
+            keys.emplace_back(keyOf(position));
+        }
+        std::unordered_map<std::string, std::int64_t> durations;
+        const bool balanced = !options.durationsFile.empty() && DurationHistory::load(options.durationsFile, durations);
+        const std::vector<std::uint32_t> shards = assignShards(keys, options.shardCount, balanced ? &durations : nullptr);
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            if (shards[i] == options.shardIndex) {
+                selected[kept++] = selected[i];
+            }
+        }
+        selected.resize(kept);
+    }
+    return selected;
+}
+
+TestSummary TestRegistry::runAll(const RegistryRunOptions& options) {
+    if (options.workerCount == 1) {
+        return runSelected(nullptr, options);
+    }
+
+    ThreadPool pool(options.workerCount);
+    return runSelected(&pool, options);
+}
+
+TestSummary TestRegistry::runAll(ThreadPool& pool, std::size_t batchSize) {
+    RegistryRunOptions options;
+    options.batchSize = batchSize;
+    return runSelected(&pool, options);
+}
+
+TestSummary TestRegistry::runAll(ThreadPool& pool, const RegistryRunOptions& options) {
+    return runSelected(&pool, options);
+}
+
+TestSummary TestRegistry::runSelected(ThreadPool* pool, const RegistryRunOptions& options) {
+    Reporter& reporter = Reporter::current();
+    reporter.beginRun();
+    TimedRun timedRun;
+
+    const std::vector<std::uint32_t> selected = select(options);
+    std::size_t selectedSerial = 0;
+    std::size_t selectedBatched = 0;
+    for (std::uint32_t position : selected) {
+        selectedSerial += table[position].serial ? 1 : 0;
+        selectedBatched += table[position].invokeBatch != nullptr ? 1 : 0;
+    }
+    auto parallel = [this](std::uint32_t position) {
+        return !table[position].serial && table[position].invokeBatch == nullptr;
+    };
+
+    // One byte per selected entry, each written by exactly one worker; only kept when a state file is wanted
+    const bool tracking = !options.stateFile.empty();
+    std::vector<std::uint8_t> failed(tracking ? selected.size() : 0);
+    // Same for the wall time of each entry, only when durations are recorded
+    const bool timing = !options.recordDurations.empty();
+    std::vector<std::int64_t> elapsed(timing ? selected.size() : 0);
+    auto run = [this, &selected, &failed, tracking, &elapsed, timing](std::size_t i) {
+        const auto start = timing ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        const bool passed = runEntry(selected[i]);
+        if (timing) {
+            elapsed[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+        if (tracking && !passed) {
+            failed[i] = 1;
+        }
+        return passed;
+    };
+
+    TestSummary summary;
+    if (pool == nullptr) {
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            if (parallel(selected[i])) {
+                summary.record(run(i));
+            }
+        }
+    }
+    else if (selected.size() > selectedSerial + selectedBatched) {
+        std::vector<WorkerTally> tallies(pool->size());
+        pool->parallelFor(selected.size(), [&selected, &tallies, &run, &parallel](std::size_t i, std::size_t worker) {
+            if (parallel(selected[i])) {
+                tallies[worker].summary.record(run(i));
+            }
+            }, options.batchSize);
+
+        for (const auto& tally : tallies) {
+            summary += tally.summary;
+        }
+    }
+    if (selectedBatched > 0) {
+        // One call per suite and batch function, in order of first appearance
+        std::vector<std::uint8_t> batchedDone(selected.size(), 0);
+        std::vector<BatchItem> items;
+        std::vector<std::size_t> itemAt;
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            const TestEntry& first = table[selected[i]];
+            if (first.invokeBatch == nullptr || batchedDone[i] != 0) {
+                continue;
+            }
+            items.clear();
+            itemAt.clear();
+            for (std::size_t j = i; j < selected.size(); ++j) {
+                const TestEntry& entry = table[selected[j]];
+                if (entry.invokeBatch == first.invokeBatch && entry.suite == first.suite) {
+                    items.push_back({ entry.index, selected[j], entry.key });
+                    itemAt.push_back(j);
+                    batchedDone[j] = 1;
+                }
+            }
+            first.invokeBatch(first.suite, items.data(), items.size());
+            for (std::size_t k = 0; k < items.size(); ++k) {
+                summary.record(items[k].passed);
+                if (tracking && !items[k].passed) {
+                    failed[itemAt[k]] = 1;
+                }
+                if (timing) {
+                    elapsed[itemAt[k]] = items[k].elapsedNs;
+                }
+            }
+        }
+    }
+    if (selectedSerial > 0) {
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            if (table[selected[i]].serial) {
+                summary.record(run(i));
+            }
+        }
+    }
+
+    FixtureRegistry::getInstance().teardown(FixtureScope::Suite);
+    reporter.endRun(summary);
+    timedRun.finish();
+    if (tracking) {
+        recordState(options, selected, failed);
+    }
+    if (timing) {
+        recordDurations(options, selected, elapsed);
+    }
+    return summary;
+}
+
+// Entries that did not run keep their previous state, so filtered runs update the file incrementally
+void TestRegistry::recordState(const RegistryRunOptions& options, const std::vector<std::uint32_t>& selected, const std::vector<std::uint8_t>& failed) const {
+    std::unordered_set<std::string> state;
+    RunState::load(options.stateFile, state);
+    for (std::size_t i = 0; i < selected.size(); ++i) {
+        std::string key(keyOf(selected[i]));
+        if (failed[i] != 0) {
+            state.insert(std::move(key));
+        }
+        else {
+            state.erase(key);
+        }
+    }
+    RunState::save(options.stateFile, state);
+}
+
+// Like recordState: entries of other shards or filters keep the duration recorded for them earlier
+void TestRegistry::recordDurations(const RegistryRunOptions& options, const std::vector<std::uint32_t>& selected, const std::vector<std::int64_t>& elapsed) const {
+    std::unordered_map<std::string, std::int64_t> durations;
+    DurationHistory::load(options.recordDurations, durations);
+    for (std::size_t i = 0; i < selected.size(); ++i) {
+        durations[std::string(keyOf(selected[i]))] = elapsed[i];
+    }
+    DurationHistory::save(options.recordDurations, durations);
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include<vector>
+#include<deque>
+#include<string>
+#include<string_view>
+#include<unordered_set>
+#include<unordered_map>
+#include<mutex>
+#include<cstdint>
+#include<algorithm>
+#include<chrono>
+#include "../ThreadPool/ThreadPool.h"
+#include "../UnitTest/TestSummary.h"
+#include "../Reporter/Reporter.h"
+#include "../Profiler/TimingRecorder.h"
+#include "TestFilter.h"
+#include "RunState.h"
+#include "Sharding.h"
+#include "../Fixture/Fixture.h"
+
+// One entry of a batched call (TestEntry::invokeBatch): index and position in, passed and elapsedNs out
+struct BatchItem {
+    std::size_t index;           // TestEntry::index
+    std::size_t position;        // table position, labels timings and reports
+    std::string_view test = {};  // key of the entry, the test context its results are reported under
+    bool passed = false;
+    std::int64_t elapsedNs = 0;
+};
+
+// One row of the registry table.
+// Plain data (no std::function, no strings) so the whole table is one contiguous array
+// and each UnitTest<T> only contributes a function pointer that knows how to call back into it.
+struct TestEntry {
+    bool (*invoke)(void* suite, std::size_t index);
+    void* suite;
+    std::size_t index;        // index of the assertion inside its suite
+    const char* suiteName;    // typeid(T).name() of the owning UnitTest<T>
+    bool serial;              // must not run concurrently with other entries
+    const char* kind = "assert";  // which list of the suite index counts in; keys unnamed entries
+    const char* name = nullptr;   // optional, see TestRegistry::intern
+    const char* tags = nullptr;   // optional comma separated list
+    // Optional: runs several entries of one suite in one call (async assertions share one EventLoop).
+    // runAll hands it every selected entry with the same suite and invokeBatch, on the calling thread.
+    void (*invokeBatch)(void* suite, BatchItem* items, std::size_t count) = nullptr;
+    const char* key = nullptr;    // filled in by TestRegistry::add, see keyOf
+};
+
+struct RegistryRunOptions {
+    std::size_t workerCount = 0;  // 0 uses every hardware thread, 1 runs everything on the calling thread
+    std::size_t batchSize = 0;    // entries handed to a worker at once, 0 picks one automatically
+    TestFilter filter;            // empty runs every entry
+    bool onlyFailed = false;      // only entries recorded as failed in stateFile (everything when there is none yet)
+    std::string stateFile;        // failures are recorded here after the run, empty = not recorded
+    std::size_t shardIndex = 0;   // run only the selected entries of this shard out of shardCount (see Sharding.h)
+    std::size_t shardCount = 1;
+    std::string durationsFile;    // balance shards by the durations recorded here, empty = by key hash
+    std::string recordDurations;  // merge the wall time of every entry that ran into this file, empty = not recorded
+};
+
+// Global, type-erased table of every assertion registered through any UnitTest<T>.
+// Registration is locked, running is not: do not register new assertions while runAll() is in progress.
+class TestRegistry {
+private:
+    std::vector<TestEntry> table;
+    std::deque<std::string> strings;  // backing store of intern(), a deque so the characters never move
+    std::unordered_map<std::string, std::size_t> sequences;  // "suite#kind" -> next nextSequence() number
+    mutable std::mutex registrationMutex;
+
+    TestRegistry() = default;
+    TestRegistry(const TestRegistry&) = delete;
+    TestRegistry& operator=(const TestRegistry&) = delete;
+
+    // Timed under its table position: entry.index is per kind, so two entries of one suite can share it.
+    // The entry's key is the test context of everything it reports.
+    bool runEntry(std::size_t position) const {
+        const TestEntry& entry = table[position];
+        TestContext::Scope context(entry.key);
+        AssertionTimer timer(entry.suiteName, position);
+        return entry.invoke(entry.suite, entry.index);
+    }
+
+public:
+    static TestRegistry& getInstance();
+
+    std::size_t add(const TestEntry& entry);
+    void clear();
+    // Drop every entry of one suite that was added with the given callback
+    void removeEntries(bool (*invoke)(void* suite, std::size_t index), const void* suite);
+
+    const std::vector<TestEntry>& entries() const { return table; }
+    std::size_t size() const { return table.size(); }
+
+    // Copy of text that stays valid until clear(), for TestEntry::name / tags
+    const char* intern(std::string_view text);
+
+    // 0, 1, 2, ... per suite and kind, until clear(): numbers the sets of a kind that a suite can register
+    // several times (StaticAssertions), so each set gets keys of its own
+    std::size_t nextSequence(std::string_view suiteName, std::string_view kind);
+
+    // "suite::name" for named entries, "suite#kind:index" otherwise; what filters, shards and the state
+    // file use. Neither depends on other suites, so a key survives entries being added elsewhere.
+    // Built once by add() and kept with the interned strings, so running an entry never formats it.
+    std::string_view keyOf(std::size_t position) const { return table[position].key; }
+
+    // Positions of the entries a run with these options executes, in table order
+    std::vector<std::uint32_t> select(const RegistryRunOptions& options) const;
+
+    // Run the whole table (or the part selected by options) in one pass: parallel entries are split into
+    // batches and spread over the pool, then batched entries (invokeBatch) and serial entries run on the calling thread.
+    TestSummary runAll(const RegistryRunOptions& options = {});
+    TestSummary runAll(ThreadPool& pool, std::size_t batchSize = 0);
+    TestSummary runAll(ThreadPool& pool, const RegistryRunOptions& options);
+
+private:
+    TestSummary runSelected(ThreadPool* pool, const RegistryRunOptions& options);
+    void recordState(const RegistryRunOptions& options, const std::vector<std::uint32_t>& selected, const std::vector<std::uint8_t>& failed) const;
+    void recordDurations(const RegistryRunOptions& options, const std::vector<std::uint32_t>& selected, const std::vector<std::int64_t>& elapsed) const;
+
+    friend class IsolatedRunner;
+};
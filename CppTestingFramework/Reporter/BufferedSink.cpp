@@ -0,0 +1,83 @@
+// BufferedSink.cpp : per-thread buffers and their hand-over to the shared stream.
+//
+
+#include "BufferedSink.h"
+
+#include <algorithm>
+
+
+BufferedSink::BufferedSink(std::ostream& out, std::size_t flushThreshold)
+    : out(out), flushThreshold(flushThreshold), id(nextId()) {
+}
+
+BufferedSink::~BufferedSink() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (ThreadBuffer* threadBuffer : attached) {
+        writeOut(threadBuffer->buffer.data);
+        std::string().swap(threadBuffer->buffer.data);  // give the reserved capacity back right away
+        threadBuffer->sink = nullptr;
+    }
+    attached.clear();
+    out.flush();
+}
+
+BufferedSink::ThreadBuffer& BufferedSink::localBuffer() {
+    ThreadBuffers& buffers = threadBuffers();
+    for (auto& threadBuffer : buffers.list) {
+        if (threadBuffer->sinkId == id) {
+            return *threadBuffer;
+        }
+    }
+
+    // First write of this thread to this sink; drop the entries of sinks destroyed since the last time
+    std::lock_guard<std::mutex> lock(registryMutex());
+    buffers.list.erase(std::remove_if(buffers.list.begin(), buffers.list.end(), [](const auto& threadBuffer) {
+        return threadBuffer->sink == nullptr;
+        }), buffers.list.end());
+    buffers.list.push_back(std::make_unique<ThreadBuffer>(id, this));
+    ThreadBuffer& created = *buffers.list.back();
+    created.buffer.data.reserve(flushThreshold + flushThreshold / 4);
+    attached.push_back(&created);
+    return created;
+}
+
+void BufferedSink::writeOut(std::string& data) {
+    if (data.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(outMutex);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    data.clear();  // keeps the capacity, so the next batch does not allocate
+}
+
+void BufferedSink::detach(ThreadBuffer* threadBuffer) {
+    attached.erase(std::remove(attached.begin(), attached.end(), threadBuffer), attached.end());
+}
+
+void BufferedSink::commit() {
+    std::string& data = localBuffer().buffer.data;
+    if (batchDepth.load(std::memory_order_relaxed) == 0 || data.size() >= flushThreshold) {
+        writeOut(data);
+    }
+}
+
+void BufferedSink::beginBatch() {
+    batchDepth.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferedSink::endBatch() {
+    if (batchDepth.fetch_sub(1, std::memory_order_relaxed) == 1) {
+        flushAll();
+    }
+}
+
+void BufferedSink::flushAll() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (ThreadBuffer* threadBuffer : attached) {
+            writeOut(threadBuffer->buffer.data);
+        }
+    }
+    std::lock_guard<std::mutex> lock(outMutex);
+    out.flush();
+}
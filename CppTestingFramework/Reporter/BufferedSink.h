@@ -0,0 +1,101 @@
+#pragma once
+#include<ostream>
+#include<streambuf>
+#include<string>
+#include<vector>
+#include<memory>
+#include<mutex>
+#include<atomic>
+#include<cstdint>
+
+// std::streambuf that appends straight into a std::string, so operator<< never needs a temporary.
+// Clearing data keeps its capacity, which makes it a reusable scratch buffer.
+class StringStreamBuf : public std::streambuf {
+public:
+    std::string data;
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            data.push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        data.append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+};
+
+// Output sink that gives every writing thread its own buffer.
+// Appending is lock-free (each thread only touches its own buffer); the shared stream is locked
+// only when a buffer is handed over, which happens once per flushThreshold bytes while a batch is open.
+// Outside a batch every committed line is passed through right away so it keeps its place among other
+// writes to the same stream.
+class BufferedSink {
+private:
+    struct ThreadBuffer {
+        std::uint64_t sinkId;     // never reused, so an entry of a destroyed sink never matches again
+        BufferedSink* sink;       // nulled when the sink goes away first, the entry is then pruned by its thread
+        StringStreamBuf buffer;
+        std::ostream stream{ &buffer };
+        ThreadBuffer(std::uint64_t id, BufferedSink* owner) : sinkId(id), sink(owner) {}
+    };
+
+    // Buffers owned by one thread, flushed back to their sinks when the thread exits
+    struct ThreadBuffers {
+        std::vector<std::unique_ptr<ThreadBuffer>> list;
+        ~ThreadBuffers() {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (auto& threadBuffer : list) {
+                if (threadBuffer->sink != nullptr) {
+                    threadBuffer->sink->writeOut(threadBuffer->buffer.data);
+                    threadBuffer->sink->detach(threadBuffer.get());
+                }
+            }
+        }
+    };
+
+    std::ostream& out;
+    std::size_t flushThreshold;
+    std::uint64_t id;
+    std::atomic<int> batchDepth{ 0 };
+    std::mutex outMutex;
+    std::vector<ThreadBuffer*> attached;  // guarded by registryMutex()
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::uint64_t nextId() {
+        static std::atomic<std::uint64_t> counter{ 0 };
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static ThreadBuffers& threadBuffers() {
+        thread_local ThreadBuffers buffers;
+        return buffers;
+    }
+
+    ThreadBuffer& localBuffer();
+    void writeOut(std::string& data);
+    void detach(ThreadBuffer* threadBuffer);
+
+public:
+    explicit BufferedSink(std::ostream& out, std::size_t flushThreshold = 64 * 1024);
+    ~BufferedSink();
+
+    BufferedSink(const BufferedSink&) = delete;
+    BufferedSink& operator=(const BufferedSink&) = delete;
+
+    // Stream writing into the calling thread's buffer. Call commit() after each complete record.
+    std::ostream& stream() { return localBuffer().stream; }
+    void commit();
+
+    // While at least one batch is open, records are only handed to the stream in big chunks
+    void beginBatch();
+    void endBatch();
+
+    // Hand every thread's buffer to the stream. Only call while no other thread is writing (e.g. after a run).
+    void flushAll();
+};
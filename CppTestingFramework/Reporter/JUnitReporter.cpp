@@ -0,0 +1,61 @@
+// JUnitReporter.cpp : streaming JUnit XML output.
+//
+
+#include "JUnitReporter.h"
+
+
+void JUnitReporter::writeHeader(const std::string& suiteName) {
+    std::ostream& os = sink.stream();
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n  <testsuite name=\"";
+    writeXmlEscaped(os, suiteName);
+    os << "\">\n";
+    sink.commit();
+}
+
+void JUnitReporter::report(const AssertionResult& result) {
+    std::ostream& os = sink.stream();
+    os << "    <testcase classname=\"";
+    const std::string_view test = result.test();
+    writeXmlEscaped(os, test.empty() ? result.suiteName : test);
+    os << "\" name=\"";
+    writeXmlEscaped(os, result.functionName);
+
+    if (result.passed) {
+        os << "\"/>\n";
+    }
+    else {
+        // message holds the first line; a multi-line diff goes in full into the element, where line breaks survive
+        std::string_view message = describeToScratch(result);
+        const std::size_t firstLineEnd = message.find('\n');
+        os << "\">\n      <failure message=\"";
+        writeXmlEscaped(os, message.substr(0, firstLineEnd));
+        if (firstLineEnd == std::string_view::npos) {
+            os << "\"/>\n    </testcase>\n";
+        }
+        else {
+            os << "\">";
+            writeXmlText(os, message);
+            os << "</failure>\n    </testcase>\n";
+        }
+    }
+    sink.commit();
+}
+
+void JUnitReporter::endRun(const TestSummary& summary) {
+    std::ostream& os = sink.stream();
+    os << "    <!-- run: tests=\"" << summary.total() << "\" failures=\"" << summary.failed << "\" -->\n";
+    sink.commit();
+    sink.endBatch();
+}
+
+void JUnitReporter::close() {
+    if (closed) {
+        return;
+    }
+    closed = true;
+    sink.flushAll();
+    std::ostream& os = sink.stream();
+    os << "  </testsuite>\n</testsuites>\n";
+    sink.commit();
+    sink.flushAll();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include<fstream>
+#include<memory>
+#include<string>
+#include "Reporter.h"
+#include "ReportFormat.h"
+
+// Streams a JUnit XML report: every result is written as its own <testcase> the moment it arrives,
+// so memory use does not grow with the number of assertions.
+// A <testcase> is classed under the registry key of its test ("Math::addition"), or under the suite when
+// the assertion ran outside the registry; its name is the assertion. A failure keeps the first line of its
+// text in the message attribute and a multi-line text (a diff) in full as the element content.
+// Because nothing is held back, the <testsuite> element carries no up-front counts; CI tools count the
+// <testcase>/<failure> elements, and the totals of each run are added as an XML comment.
+class JUnitReporter : public Reporter {
+private:
+    std::unique_ptr<std::ofstream> ownedFile;
+    BufferedSink sink;
+    bool closed = false;
+
+    void writeHeader(const std::string& suiteName);
+
+public:
+    explicit JUnitReporter(std::ostream& out, const std::string& suiteName = "CppTestingFramework")
+        : sink(out) {
+        writeHeader(suiteName);
+    }
+
+    explicit JUnitReporter(const std::string& path, const std::string& suiteName = "CppTestingFramework")
+        : ownedFile(std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc)), sink(*ownedFile) {
+        writeHeader(suiteName);
+    }
+
+    ~JUnitReporter() override { close(); }
+
+    void report(const AssertionResult& result) override;
+
+    void beginRun() override { sink.beginBatch(); }
+
+    void endRun(const TestSummary& summary) override;
+
+    void flush() override { sink.flushAll(); }
+
+    // Write the closing tags. Called by the destructor; no results may be reported afterwards.
+    void close();
+};
@@ -0,0 +1,36 @@
+// JsonLinesReporter.cpp : one JSON object per result and per run.
+//
+
+#include "JsonLinesReporter.h"
+
+
+void JsonLinesReporter::report(const AssertionResult& result) {
+    std::ostream& os = sink.stream();
+    os << "{\"type\":\"assertion\",";
+    const std::string_view test = result.test();
+    if (!test.empty()) {
+        os << "\"test\":\"";
+        writeJsonEscaped(os, test);
+        os << "\",";
+    }
+    os << "\"suite\":\"";
+    writeJsonEscaped(os, result.suiteName);
+    os << "\",\"name\":\"";
+    writeJsonEscaped(os, result.functionName);
+    os << "\",\"passed\":" << (result.passed ? "true" : "false");
+
+    if (!result.passed || includePassingMessages) {
+        os << ",\"message\":\"";
+        writeJsonEscaped(os, describeToScratch(result));
+        os << '"';
+    }
+    os << "}\n";
+    sink.commit();
+}
+
+void JsonLinesReporter::endRun(const TestSummary& summary) {
+    std::ostream& os = sink.stream();
+    os << "{\"type\":\"summary\",\"passed\":" << summary.passed << ",\"failed\":" << summary.failed << "}\n";
+    sink.commit();
+    sink.endBatch();
+}
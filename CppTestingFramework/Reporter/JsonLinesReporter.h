@@ -0,0 +1,37 @@
+#pragma once
+#include<fstream>
+#include<memory>
+#include<string>
+#include "Reporter.h"
+#include "ReportFormat.h"
+
+// Streams one JSON object per line:
+//   {"type":"assertion","test":"Math::addition","suite":"i","name":"assertEqual","passed":false,"message":"1 != 2"}
+//   {"type":"summary","passed":9,"failed":1}   (at the end of every run)
+// "test" is the registry key of the entry that reported, left out for assertions run outside the registry.
+// Each line is complete on its own, so the file can be consumed while the run is still going.
+class JsonLinesReporter : public Reporter {
+private:
+    std::unique_ptr<std::ofstream> ownedFile;
+    BufferedSink sink;
+    bool includePassingMessages;
+
+public:
+    // includePassingMessages == false only formats the compared values of failures
+    explicit JsonLinesReporter(std::ostream& out, bool includePassingMessages = false)
+        : sink(out), includePassingMessages(includePassingMessages) {
+    }
+
+    explicit JsonLinesReporter(const std::string& path, bool includePassingMessages = false)
+        : ownedFile(std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc)), sink(*ownedFile),
+        includePassingMessages(includePassingMessages) {
+    }
+
+    void report(const AssertionResult& result) override;
+
+    void beginRun() override { sink.beginBatch(); }
+
+    void endRun(const TestSummary& summary) override;
+
+    void flush() override { sink.flushAll(); }
+};
@@ -0,0 +1,40 @@
+// MultiReporter.cpp : fanning results out to several reporters.
+//
+
+#include "MultiReporter.h"
+
+
+bool MultiReporter::wants(bool passed) const {
+    for (const Reporter* reporter : reporters) {
+        if (reporter->wants(passed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MultiReporter::report(const AssertionResult& result) {
+    for (Reporter* reporter : reporters) {
+        if (reporter->wants(result.passed)) {
+            reporter->report(result);
+        }
+    }
+}
+
+void MultiReporter::beginRun() {
+    for (Reporter* reporter : reporters) {
+        reporter->beginRun();
+    }
+}
+
+void MultiReporter::endRun(const TestSummary& summary) {
+    for (Reporter* reporter : reporters) {
+        reporter->endRun(summary);
+    }
+}
+
+void MultiReporter::flush() {
+    for (Reporter* reporter : reporters) {
+        reporter->flush();
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include<vector>
+#include<initializer_list>
+#include "Reporter.h"
+
+// Forwards every result to several reporters, e.g. console output plus a JUnit file
+class MultiReporter : public Reporter {
+private:
+    std::vector<Reporter*> reporters;
+
+public:
+    MultiReporter(std::initializer_list<Reporter*> targets) : reporters(targets) {}
+
+    void add(Reporter* reporter) { reporters.push_back(reporter); }
+
+    bool wants(bool passed) const override;
+
+    void report(const AssertionResult& result) override;
+
+    void beginRun() override;
+
+    void endRun(const TestSummary& summary) override;
+
+    void flush() override;
+};
@@ -0,0 +1,71 @@
+// ReportFormat.cpp : escaping and formatting shared by the machine readable reporters.
+//
+
+#include "ReportFormat.h"
+
+
+std::string_view describeToScratch(const AssertionResult& result) {
+    thread_local StringStreamBuf scratch;
+    thread_local std::ostream scratchStream(&scratch);
+
+    scratch.data.clear();
+    if (result.describe != nullptr) {
+        result.describe(scratchStream, result.context);
+    }
+    return scratch.data;
+}
+
+namespace {
+    // Attribute values are normalized by XML parsers (a raw newline reads back as a space), so there the
+    // whitespace that matters is written as character references
+    void writeXml(std::ostream& os, std::string_view text, bool attribute) {
+        for (char ch : text) {
+            switch (ch) {
+            case '&': os << "&amp;"; break;
+            case '<': os << "&lt;"; break;
+            case '>': os << "&gt;"; break;
+            case '"': os << "&quot;"; break;
+            case '\'': os << "&apos;"; break;
+            case '\n': os << (attribute ? "&#10;" : "\n"); break;
+            case '\r': os << "&#13;"; break;  // a raw one would read back as a newline in content too
+            case '\t': os << (attribute ? "&#9;" : "\t"); break;
+            default:
+                // Other control characters are not allowed in XML 1.0
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    os << '?';
+                }
+                else {
+                    os << ch;
+                }
+            }
+        }
+    }
+}
+
+void writeXmlEscaped(std::ostream& os, std::string_view text) {
+    writeXml(os, text, true);
+}
+
+void writeXmlText(std::ostream& os, std::string_view text) {
+    writeXml(os, text, false);
+}
+
+void writeJsonEscaped(std::ostream& os, std::string_view text) {
+    static constexpr char hex[] = "0123456789abcdef";
+    for (char ch : text) {
+        switch (ch) {
+        case '"': os << "\\\""; break;
+        case '\\': os << "\\\\"; break;
+        case '\n': os << "\\n"; break;
+        case '\r': os << "\\r"; break;
+        case '\t': os << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                os << "\\u00" << hex[(ch >> 4) & 0xF] << hex[ch & 0xF];
+            }
+            else {
+                os << ch;
+            }
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include<ostream>
+#include<string_view>
+#include "BufferedSink.h"
+#include "Reporter.h"
+
+// Helpers shared by the machine readable reporters
+
+// Run result.describe into a per-thread scratch buffer that keeps its capacity between calls
+std::string_view describeToScratch(const AssertionResult& result);
+
+// text as XML attribute content (line breaks as character references) / XML element content / JSON string content
+void writeXmlEscaped(std::ostream& os, std::string_view text);
+void writeXmlText(std::ostream& os, std::string_view text);
+void writeJsonEscaped(std::ostream& os, std::string_view text);
@@ -0,0 +1,39 @@
+// Reporter.cpp : the installed reporter and the console output.
+//
+
+#include "Reporter.h"
+
+
+Reporter& Reporter::current() {
+    Reporter* reporter = installed.load(std::memory_order_acquire);
+    if (reporter != nullptr) {
+        return *reporter;
+    }
+    static ConsoleReporter defaultReporter;
+    return defaultReporter;
+}
+
+void Reporter::setCurrent(Reporter* reporter) {
+    installed.store(reporter, std::memory_order_release);
+}
+
+void ConsoleReporter::report(const AssertionResult& result) {
+    std::ostream& os = sink.stream();
+    os << (result.passed ? "[PASS] " : "[FAIL] ");
+    const std::string_view test = result.test();
+    if (!test.empty()) {
+        os << '[' << test;
+        if (!result.functionName.empty()) {
+            os << "::" << result.functionName;
+        }
+        os << "] ";
+    }
+    else if (!result.functionName.empty()) {
+        os << '[' << result.suiteName << "::" << result.functionName << "] ";
+    }
+    if (result.describe != nullptr) {
+        result.describe(os, result.context);
+    }
+    os << '\n';
+    sink.commit();
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include<iostream>
+#include<string_view>
+#include<atomic>
+#include "BufferedSink.h"
+#include "../UnitTest/TestSummary.h"
+
+// Registry key of the entry running on this thread ("Suite::name" or "suite#kind:index"), empty outside one.
+// TestRegistry::runEntry sets it for the duration of the entry; reporters name every result by it.
+class TestContext {
+private:
+    inline static thread_local std::string_view key;
+
+public:
+    static std::string_view current() { return key; }
+
+    class Scope {
+    private:
+        std::string_view previous;
+
+    public:
+        explicit Scope(std::string_view test) : previous(key) { key = test; }
+        ~Scope() { key = previous; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+// Everything an assertion hands to a reporter.
+// The compared values are not formatted up front: describe() writes them on demand,
+// so a reporter that drops the result never pays for formatting.
+struct AssertionResult {
+    bool passed;
+    std::string_view suiteName;
+    std::string_view functionName;
+    void (*describe)(std::ostream& os, const void* context);  // may be null
+    const void* context;
+    std::string_view testName = {};  // set by results replayed from elsewhere, see test()
+
+    // Key of the test the result belongs to: testName, or the entry running on this thread
+    std::string_view test() const { return testName.empty() ? TestContext::current() : testName; }
+};
+
+// Receives assertion results. report() can be called from several threads at once.
+class Reporter {
+public:
+    virtual ~Reporter() = default;
+
+    // Checked before anything is formatted, return false to skip the result entirely
+    virtual bool wants(bool /*passed*/) const { return true; }
+    virtual void report(const AssertionResult& result) = 0;
+
+    // Bracket a test run (runTests, runTestsParallel, TestRegistry::runAll); runs may nest
+    virtual void beginRun() {}
+    virtual void endRun(const TestSummary& /*summary*/) {}
+
+    virtual void flush() {}
+
+    // Reporter every assertion writes to. Defaults to a ConsoleReporter on std::cout.
+    static Reporter& current();
+    // nullptr restores the default console reporter. The reporter must outlive its use.
+    static void setCurrent(Reporter* reporter);
+
+private:
+    inline static std::atomic<Reporter*> installed{ nullptr };
+};
+
+// Human readable "[PASS] [test::function] details" lines, "[suite::function]" outside a registry entry.
+// Lines go through a per-thread BufferedSink; in quiet mode passing assertions are dropped before formatting.
+class ConsoleReporter : public Reporter {
+private:
+    BufferedSink sink;
+    std::atomic<bool> quiet;
+
+public:
+    explicit ConsoleReporter(std::ostream& out = std::cout, bool quiet = false)
+        : sink(out), quiet(quiet) {
+    }
+
+    void setQuiet(bool enabled) { quiet.store(enabled, std::memory_order_relaxed); }
+
+    bool wants(bool passed) const override {
+        return !passed || !quiet.load(std::memory_order_relaxed);
+    }
+
+    void report(const AssertionResult& result) override;
+
+    void beginRun() override { sink.beginBatch(); }
+    void endRun(const TestSummary& /*summary*/) override { sink.endBatch(); }
+    void flush() override { sink.flushAll(); }
+};
@@ -0,0 +1,136 @@
+// ResultMerge.cpp : parsing JSON lines result files and replaying them into a reporter.
+//
+
+#include "ResultMerge.h"
+
+#include <charconv>
+
+
+bool parseJsonLine(std::string_view line, std::vector<std::pair<std::string, std::string>>& fields) {
+    fields.clear();
+    std::size_t i = 0;
+    auto skipSpace = [&]() {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+    };
+    auto readString = [&](std::string& out) {
+        if (i >= line.size() || line[i] != '"') return false;
+        ++i;
+        out.clear();
+        while (i < line.size() && line[i] != '"') {
+            char ch = line[i++];
+            if (ch != '\\') {
+                out += ch;
+                continue;
+            }
+            if (i >= line.size()) return false;
+            switch (char escape = line[i++]) {
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                unsigned code = 0;
+                if (i + 4 > line.size() || std::from_chars(line.data() + i, line.data() + i + 4, code, 16).ec != std::errc()) return false;
+                i += 4;
+                // JsonLinesReporter only escapes control characters; anything else is written as UTF-8
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                }
+                else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: out += escape; break;  // \" \\ \/
+            }
+        }
+        if (i >= line.size()) return false;
+        ++i;
+        return true;
+    };
+
+    skipSpace();
+    if (i >= line.size() || line[i++] != '{') return false;
+    skipSpace();
+    if (i < line.size() && line[i] == '}') return true;
+    while (true) {
+        std::pair<std::string, std::string> field;
+        skipSpace();
+        if (!readString(field.first)) return false;
+        skipSpace();
+        if (i >= line.size() || line[i++] != ':') return false;
+        skipSpace();
+        if (i < line.size() && line[i] == '"') {
+            if (!readString(field.second)) return false;
+        }
+        else {
+            const std::size_t start = i;
+            while (i < line.size() && line[i] != ',' && line[i] != '}') ++i;
+            std::string_view raw = line.substr(start, i - start);
+            while (!raw.empty() && raw.back() == ' ') raw.remove_suffix(1);
+            field.second = raw;
+        }
+        fields.push_back(std::move(field));
+        skipSpace();
+        if (i >= line.size()) return false;
+        if (line[i] == '}') return true;
+        if (line[i++] != ',') return false;
+    }
+}
+
+void replayJsonLines(std::istream& in, Reporter& reporter, TestSummary& summary, MergeStatistics& statistics) {
+    std::vector<std::pair<std::string, std::string>> fields;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (!parseJsonLine(line, fields)) {
+            ++statistics.malformedLines;
+            continue;
+        }
+        auto field = [&fields](std::string_view name) -> const std::string* {
+            for (const auto& [key, value] : fields) {
+                if (key == name) return &value;
+            }
+            return nullptr;
+        };
+        const std::string* type = field("type");
+        if (type == nullptr) {
+            ++statistics.malformedLines;
+        }
+        else if (*type == "assertion") {
+            const std::string* test = field("test");
+            const std::string* suite = field("suite");
+            const std::string* name = field("name");
+            const std::string* passed = field("passed");
+            const std::string* message = field("message");
+            const bool ok = passed != nullptr && *passed == "true";
+            ++statistics.assertions;
+            statistics.failedAssertions += ok ? 0 : 1;
+            if (reporter.wants(ok)) {
+                reporter.report({ ok, suite != nullptr ? std::string_view(*suite) : std::string_view(),
+                    name != nullptr ? std::string_view(*name) : std::string_view(),
+                    message != nullptr ? +[](std::ostream& os, const void* context) { os << *static_cast<const std::string*>(context); }
+                                       : nullptr,
+                    message, test != nullptr ? std::string_view(*test) : std::string_view() });
+            }
+        }
+        else if (*type == "summary") {
+            std::size_t passed = 0;
+            std::size_t failed = 0;
+            if (const std::string* value = field("passed")) std::from_chars(value->data(), value->data() + value->size(), passed);
+            if (const std::string* value = field("failed")) std::from_chars(value->data(), value->data() + value->size(), failed);
+            summary.passed += passed;
+            summary.failed += failed;
+            ++statistics.runs;
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include<istream>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<utility>
+#include "Reporter.h"
+
+// Reading JsonLinesReporter output back, so the result files of several shards can be merged into one
+// report (see Runner/MergeMain.cpp). Every assertion line is replayed into a Reporter as if the assertion
+// had just run; summary lines are added up.
+// A file is only trustworthy with exactly one summary line (a shard that crashed never wrote one) and
+// with failing assertion lines exactly when its summary counts failures; cpptf_merge checks both per file.
+
+// Fields of one flat JSON object line as (name, value) pairs; string values are unescaped, other values
+// are kept as written. false when the line is not a flat object.
+bool parseJsonLine(std::string_view line, std::vector<std::pair<std::string, std::string>>& fields);
+
+struct MergeStatistics {
+    std::size_t assertions = 0;
+    std::size_t failedAssertions = 0;
+    std::size_t malformedLines = 0;
+    std::size_t runs = 0;      // summary lines seen
+
+    MergeStatistics& operator+=(const MergeStatistics& other) {
+        assertions += other.assertions;
+        failedAssertions += other.failedAssertions;
+        malformedLines += other.malformedLines;
+        runs += other.runs;
+        return *this;
+    }
+};
+
+// Replay one JSON lines result file into reporter, adding its summary lines to summary
+void replayJsonLines(std::istream& in, Reporter& reporter, TestSummary& summary, MergeStatistics& statistics);
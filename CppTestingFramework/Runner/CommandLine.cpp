@@ -0,0 +1,192 @@
+// CommandLine.cpp : argument parsing and the run loop of the test runner.
+// Compiled once into the cpptf library, so test binaries only pay for their own tests.
+//
+
+#include "CommandLine.h"
+#include "../Registry/AutoRegistration.h"
+#include "../Reporter/Reporter.h"
+#include "../Reporter/JUnitReporter.h"
+#include "../Reporter/JsonLinesReporter.h"
+
+#include <iostream>
+#include <memory>
+#include <charconv>
+#include <string_view>
+
+
+namespace {
+    bool parseCount(std::string_view text, std::size_t& value) {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+}
+
+bool parseRunnerOptions(int argc, const char* const* argv, RunnerOptions& options, std::string& error) {
+    bool rerunFailed = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        std::string_view value;
+        bool hasValue = false;
+        if (argument.substr(0, 2) == "--") {
+            const std::size_t equals = argument.find('=');
+            if (equals != std::string_view::npos) {
+                value = argument.substr(equals + 1);
+                argument = argument.substr(0, equals);
+                hasValue = true;
+            }
+        }
+
+        // Value of an option that takes one, from "=value" or the next argument
+        auto next = [&](std::string_view& out) {
+            if (hasValue) {
+                out = value;
+                return true;
+            }
+            if (i + 1 < argc) {
+                out = argv[++i];
+                return true;
+            }
+            error = "missing value for " + std::string(argument);
+            return false;
+        };
+        auto count = [&](std::size_t& out) {
+            std::string_view text;
+            if (!next(text)) {
+                return false;
+            }
+            if (!parseCount(text, out)) {
+                error = "not a number for " + std::string(argument) + ": " + std::string(text);
+                return false;
+            }
+            return true;
+        };
+
+        std::string_view text;
+        if (argument == "-h" || argument == "--help") {
+            options.help = true;
+        }
+        else if (argument == "-l" || argument == "--list") {
+            options.list = true;
+        }
+        else if (argument == "-j" || argument == "--threads") {
+            if (!count(options.run.workerCount)) return false;
+        }
+        else if (argument == "-f" || argument == "--filter") {
+            if (!next(text)) return false;
+            options.run.filter = TestFilter::parse(text);
+        }
+        else if (argument == "-r" || argument == "--reporter") {
+            if (!next(text)) return false;
+            if (text != "console" && text != "quiet" && text != "junit" && text != "jsonl") {
+                error = "unknown reporter: " + std::string(text);
+                return false;
+            }
+            options.reporter = text;
+        }
+        else if (argument == "-o" || argument == "--output") {
+            if (!next(text)) return false;
+            options.output = text;
+        }
+        else if (argument == "--shard-index") {
+            if (!count(options.run.shardIndex)) return false;
+        }
+        else if (argument == "--shard-count") {
+            if (!count(options.run.shardCount)) return false;
+        }
+        else if (argument == "--durations") {
+            if (!next(text)) return false;
+            options.run.durationsFile = text;
+        }
+        else if (argument == "--record-durations") {
+            if (!next(text)) return false;
+            options.run.recordDurations = text;
+        }
+        else if (argument == "--rerun-failed") {
+            rerunFailed = true;
+        }
+        else if (argument == "--state-file") {
+            if (!next(text)) return false;
+            options.run.stateFile = text;
+        }
+        else {
+            error = "unknown option: " + std::string(argv[i]);
+            return false;
+        }
+    }
+
+    if (options.run.shardCount == 0 || options.run.shardIndex >= options.run.shardCount) {
+        error = "--shard-index must be below --shard-count";
+        return false;
+    }
+    if (rerunFailed) {
+        options.run.onlyFailed = true;
+    }
+    if (options.run.stateFile.empty()) {
+        options.run.stateFile = RunState::defaultPath;  // always recorded, so --rerun-failed works next time
+    }
+    return true;
+}
+
+void printRunnerUsage(std::ostream& os, const char* program) {
+    os << "usage: " << program << " [options]\n"
+        "  -j, --threads N       worker threads (0 = all cores, 1 = main thread only)\n"
+        "  -f, --filter SPEC     e.g. \"Math::*,-*slow*,[fast],-[flaky]\"\n"
+        "  -r, --reporter NAME   console, quiet, junit or jsonl\n"
+        "  -o, --output PATH     report file for junit / jsonl\n"
+        "  --shard-index I       run shard I of --shard-count N\n"
+        "  --shard-count N\n"
+        "  --durations PATH      balance shards by the durations recorded in PATH\n"
+        "  --record-durations PATH  merge this run's durations into PATH\n"
+        "  --rerun-failed        only the tests that failed last time\n"
+        "  --state-file PATH     failure record (default " << RunState::defaultPath << ")\n"
+        "  -l, --list            list the selected tests and exit\n"
+        "  -h, --help\n";
+}
+
+int runRegisteredTests(const RunnerOptions& options) {
+    TestRegistry& registry = TestRegistry::getInstance();
+    AutoTests::registerAll(registry);
+
+    if (options.list) {
+        for (std::uint32_t position : registry.select(options.run)) {
+            std::cout << registry.keyOf(position) << '\n';
+        }
+        return 0;
+    }
+
+    std::unique_ptr<Reporter> reporter;
+    if (options.reporter == "quiet") {
+        reporter = std::make_unique<ConsoleReporter>(std::cout, true);
+    }
+    else if (options.reporter == "junit") {
+        reporter = options.output.empty() ? std::make_unique<JUnitReporter>(std::cout) : std::make_unique<JUnitReporter>(options.output);
+    }
+    else if (options.reporter == "jsonl") {
+        reporter = options.output.empty() ? std::make_unique<JsonLinesReporter>(std::cout) : std::make_unique<JsonLinesReporter>(options.output);
+    }
+    if (reporter) {
+        Reporter::setCurrent(reporter.get());
+    }
+
+    const TestSummary summary = registry.runAll(options.run);
+    Reporter::setCurrent(nullptr);
+    reporter.reset();  // closes report files
+
+    std::cerr << summary.passed << " passed, " << summary.failed << " failed" << std::endl;
+    return summary.failed == 0 ? 0 : 1;
+}
+
+int runnerMain(int argc, const char* const* argv) {
+    RunnerOptions options;
+    std::string error;
+    if (!parseRunnerOptions(argc, argv, options, error)) {
+        std::cerr << error << '\n';
+        printRunnerUsage(std::cerr, argc > 0 ? argv[0] : "runner");
+        return 2;
+    }
+    if (options.help) {
+        printRunnerUsage(std::cout, argc > 0 ? argv[0] : "runner");
+        return 0;
+    }
+    return runRegisteredTests(options);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include<string>
+#include<iosfwd>
+#include "../Registry/TestRegistry.h"
+
+// Command line of the test runner (cpptf_main, see CMakeLists.txt).
+// A test binary made of self-registered tests (AutoRegistration.h) linked with cpptf_main accepts:
+//     -j, --threads N          worker threads, 0 = every hardware thread, 1 = run on the main thread
+//     -f, --filter SPEC        TestFilter::parse syntax, e.g. "Math::*,-*slow*,[fast]"
+//     -r, --reporter NAME      console (default), quiet, junit, jsonl
+//     -o, --output PATH        report file for junit / jsonl, standard output when absent
+//     --shard-index I          run only shard I of --shard-count N (see Sharding.h)
+//     --shard-count N
+//     --durations PATH         balance the shards by the durations recorded in PATH instead of by name hash
+//     --record-durations PATH  merge the wall time of every test that ran into PATH
+//     --rerun-failed           only the tests that failed in the last run (see RunState.h)
+//     --state-file PATH        where failures are recorded, RunState::defaultPath by default
+//     -l, --list               print the selected tests instead of running them
+//     -h, --help
+// Both "--option value" and "--option=value" are accepted.
+
+struct RunnerOptions {
+    RegistryRunOptions run;
+    std::string reporter = "console";
+    std::string output;
+    bool list = false;
+    bool help = false;
+};
+
+// false with a message in error for unknown options or bad values
+bool parseRunnerOptions(int argc, const char* const* argv, RunnerOptions& options, std::string& error);
+void printRunnerUsage(std::ostream& os, const char* program);
+
+// Register the self-registered tests and run (or list) them; returns the process exit code
+int runRegisteredTests(const RunnerOptions& options);
+
+// Everything a runner main() does: parse, report usage errors, run
+int runnerMain(int argc, const char* const* argv);
@@ -0,0 +1,150 @@
+// MergeMain.cpp : cpptf_merge, combines the result files of sharded runs into one report.
+//
+//     cpptf_merge results [-r console|quiet|junit|jsonl] [-o PATH] shard0.jsonl shard1.jsonl ...
+//         every shard ran with "--reporter jsonl --output shardN.jsonl"; the assertions of all shards are
+//         replayed into one reporter and the run summaries added up. Exit code 1 when anything failed,
+//         2 when a result file is missing, does not hold exactly one summary line (the shard crashed or
+//         was cut short), or has failing assertion lines while its summary counts no failure (or the reverse).
+//     cpptf_merge durations -o durations.tsv shard0.tsv shard1.tsv ...
+//         merges the --record-durations files of the shards into the file the next run balances by.
+//
+
+#include "../Reporter/ResultMerge.h"
+#include "../Reporter/JUnitReporter.h"
+#include "../Reporter/JsonLinesReporter.h"
+#include "../Registry/Sharding.h"
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace {
+    void printUsage(std::ostream& os) {
+        os << "usage: cpptf_merge results [-r console|quiet|junit|jsonl] [-o PATH] FILE...\n"
+            "       cpptf_merge durations -o PATH FILE...\n";
+    }
+
+    int mergeResults(const std::string& reporterName, const std::string& output, const std::vector<std::string>& files) {
+        std::unique_ptr<Reporter> reporter;
+        if (reporterName == "console" || reporterName == "quiet") {
+            reporter = std::make_unique<ConsoleReporter>(std::cout, reporterName == "quiet");
+        }
+        else if (reporterName == "junit") {
+            reporter = output.empty() ? std::make_unique<JUnitReporter>(std::cout) : std::make_unique<JUnitReporter>(output);
+        }
+        else if (reporterName == "jsonl") {
+            reporter = output.empty() ? std::make_unique<JsonLinesReporter>(std::cout, true) : std::make_unique<JsonLinesReporter>(output, true);
+        }
+        else {
+            std::cerr << "unknown reporter: " << reporterName << '\n';
+            return 2;
+        }
+
+        TestSummary summary;
+        MergeStatistics statistics;
+        bool invalid = false;
+        reporter->beginRun();
+        for (const std::string& path : files) {
+            std::ifstream in(path);
+            if (!in) {
+                std::cerr << "cannot read " << path << '\n';
+                invalid = true;
+                continue;
+            }
+            TestSummary fileSummary;
+            MergeStatistics fileStatistics;
+            replayJsonLines(in, *reporter, fileSummary, fileStatistics);
+            if (fileStatistics.runs != 1) {
+                std::cerr << path << ": " << fileStatistics.runs << " summary lines, expected exactly 1"
+                    << (fileStatistics.runs == 0 ? " (the shard crashed or was cut short)\n" : " (several runs wrote to this file)\n");
+                invalid = true;
+            }
+            else if ((fileStatistics.failedAssertions > 0) != (fileSummary.failed > 0)) {
+                std::cerr << path << ": " << fileStatistics.failedAssertions << " failing assertion lines, but the summary counts "
+                    << fileSummary.failed << " failures\n";
+                invalid = true;
+            }
+            summary += fileSummary;
+            statistics += fileStatistics;
+        }
+        reporter->endRun(summary);
+        reporter->flush();
+        reporter.reset();
+
+        std::cerr << "merged " << files.size() << " files, " << statistics.runs << " runs, " << statistics.assertions << " assertions ("
+            << statistics.failedAssertions << " failing): " << summary.passed << " passed, " << summary.failed << " failed";
+        if (statistics.malformedLines > 0) {
+            std::cerr << " (" << statistics.malformedLines << " malformed lines skipped)";
+        }
+        std::cerr << std::endl;
+        if (invalid) {
+            return 2;
+        }
+        return summary.failed == 0 ? 0 : 1;
+    }
+
+    int mergeDurations(const std::string& output, const std::vector<std::string>& files) {
+        if (output.empty()) {
+            std::cerr << "durations: -o PATH is required\n";
+            return 2;
+        }
+        std::unordered_map<std::string, std::int64_t> durations;
+        for (const std::string& path : files) {
+            if (!DurationHistory::load(path, durations)) {
+                std::cerr << "cannot read " << path << '\n';
+                return 2;
+            }
+        }
+        if (!DurationHistory::save(output, durations)) {
+            std::cerr << "cannot write " << output << '\n';
+            return 2;
+        }
+        std::cerr << "merged " << durations.size() << " durations from " << files.size() << " files" << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        printUsage(std::cerr);
+        return 2;
+    }
+    const std::string_view mode = argv[1];
+    std::string reporterName = "console";
+    std::string output;
+    std::vector<std::string> files;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        if ((argument == "-r" || argument == "--reporter") && i + 1 < argc) {
+            reporterName = argv[++i];
+        }
+        else if ((argument == "-o" || argument == "--output") && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else if (argument == "-h" || argument == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+        else {
+            files.emplace_back(argument);
+        }
+    }
+    if (files.empty()) {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    if (mode == "results") {
+        return mergeResults(reporterName, output, files);
+    }
+    if (mode == "durations") {
+        return mergeDurations(output, files);
+    }
+    printUsage(std::cerr);
+    return 2;
+}
@@ -0,0 +1,7 @@
+#pragma once
+// Precompiled once in cpptf and reused by the test targets (see CMakeLists.txt). UnitTest.h is included from
+// here rather than precompiled directly, so test files that include it again hit its #pragma once.
+#include "../UnitTest/UnitTest.h"
+#include "../Reporter/JUnitReporter.h"
+#include "../Reporter/JsonLinesReporter.h"
+#include "../Reporter/MultiReporter.h"
@@ -0,0 +1,11 @@
+// RunnerMain.cpp : main() of the cpptf_main library. Link it into a binary of self-registered tests
+// instead of writing a main() (see CommandLine.h for the options).
+//
+
+#include "CommandLine.h"
+
+
+int main(int argc, char** argv)
+{
+    return runnerMain(argc, argv);
+}
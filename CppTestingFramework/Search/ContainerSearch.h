@@ -0,0 +1,211 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<string_view>
+#include<type_traits>
+#include<ranges>
+#include<iterator>
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#define CPPTF_SEARCH_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include<emmintrin.h>
+#define CPPTF_SEARCH_SSE2 1
+#endif
+
+// Membership search used by assertIn / assertNotIn, dispatched on what the container can do:
+//   string-like haystack and needle  -> substring search
+//   container with contains()/find() -> the container's own lookup (set, map, unordered_*)
+//   contiguous range of arithmetic   -> SIMD scan
+//   anything else                    -> linear scan
+
+namespace cpptf_search_detail {
+
+    // Scalar tail / fallback, written without an early exit per element so compilers can vectorise it
+    template <typename U>
+    bool blockContains(const U* data, std::size_t count, U value) {
+        constexpr std::size_t block = 32;
+        std::size_t i = 0;
+        for (; i + block <= count; i += block) {
+            bool found = false;
+            for (std::size_t j = 0; j < block; ++j) {
+                found |= (data[i + j] == value);
+            }
+            if (found) {
+                return true;
+            }
+        }
+        for (; i < count; ++i) {
+            if (data[i] == value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+#ifdef CPPTF_SEARCH_SSE2
+    // Lane compare for one 16-byte vector, non-zero mask when any lane equals the needle
+    template <typename U>
+    int compareSse2(__m128i chunk, __m128i needle) {
+        if constexpr (std::is_same_v<U, float>) {
+            return _mm_movemask_ps(_mm_cmpeq_ps(_mm_castsi128_ps(chunk), _mm_castsi128_ps(needle)));
+        }
+        else if constexpr (std::is_same_v<U, double>) {
+            return _mm_movemask_pd(_mm_cmpeq_pd(_mm_castsi128_pd(chunk), _mm_castsi128_pd(needle)));
+        }
+        else if constexpr (sizeof(U) == 1) {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        }
+        else if constexpr (sizeof(U) == 2) {
+            return _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, needle));
+        }
+        else if constexpr (sizeof(U) == 4) {
+            return _mm_movemask_epi8(_mm_cmpeq_epi32(chunk, needle));
+        }
+        else {
+            // No 64-bit compare in SSE2: both 32-bit halves have to match
+            __m128i halves = _mm_cmpeq_epi32(chunk, needle);
+            return _mm_movemask_pd(_mm_castsi128_pd(_mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)))));
+        }
+    }
+
+    // compareSse2 result when every lane matched
+    template <typename U>
+    constexpr int fullMaskSse2() {
+        if constexpr (std::is_same_v<U, float>) {
+            return 0xF;
+        }
+        else if constexpr (std::is_same_v<U, double> || sizeof(U) == 8) {
+            return 0x3;
+        }
+        else {
+            return 0xFFFF;
+        }
+    }
+
+    template <typename U>
+    __m128i broadcastSse2(U value) {
+        if constexpr (std::is_same_v<U, float>) {
+            return _mm_castps_si128(_mm_set1_ps(value));
+        }
+        else if constexpr (std::is_same_v<U, double>) {
+            return _mm_castpd_si128(_mm_set1_pd(value));
+        }
+        else if constexpr (sizeof(U) == 1) {
+            return _mm_set1_epi8(static_cast<char>(value));
+        }
+        else if constexpr (sizeof(U) == 2) {
+            return _mm_set1_epi16(static_cast<short>(value));
+        }
+        else if constexpr (sizeof(U) == 4) {
+            return _mm_set1_epi32(static_cast<int>(value));
+        }
+        else {
+            return _mm_set1_epi64x(static_cast<long long>(value));
+        }
+    }
+#endif
+
+#ifdef CPPTF_SEARCH_AVX2
+    template <typename U>
+    int compareAvx2(__m256i chunk, __m256i needle) {
+        if constexpr (std::is_same_v<U, float>) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(chunk), _mm256_castsi256_ps(needle), _CMP_EQ_OQ));
+        }
+        else if constexpr (std::is_same_v<U, double>) {
+            return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(chunk), _mm256_castsi256_pd(needle), _CMP_EQ_OQ));
+        }
+        else if constexpr (sizeof(U) == 1) {
+            return _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        }
+        else if constexpr (sizeof(U) == 2) {
+            return _mm256_movemask_epi8(_mm256_cmpeq_epi16(chunk, needle));
+        }
+        else if constexpr (sizeof(U) == 4) {
+            return _mm256_movemask_epi8(_mm256_cmpeq_epi32(chunk, needle));
+        }
+        else {
+            return _mm256_movemask_epi8(_mm256_cmpeq_epi64(chunk, needle));
+        }
+    }
+
+    template <typename U>
+    constexpr int fullMaskAvx2() {
+        if constexpr (std::is_same_v<U, float>) {
+            return 0xFF;
+        }
+        else if constexpr (std::is_same_v<U, double>) {
+            return 0xF;
+        }
+        else {
+            return -1;  // all 32 byte bits
+        }
+    }
+#endif
+
+    template <typename U>
+    constexpr bool simdSearchable = std::is_arithmetic_v<U> && !std::is_same_v<U, bool> && !std::is_same_v<U, long double>;
+}
+
+// Is value one of data[0..count)? Uses AVX2 or SSE2 when the build targets them.
+template <typename U>
+bool simdContains(const U* data, std::size_t count, U value) {
+    using namespace cpptf_search_detail;
+    std::size_t i = 0;
+
+    if constexpr (simdSearchable<U>) {
+#if defined(CPPTF_SEARCH_AVX2)
+        constexpr std::size_t lanes = 32 / sizeof(U);
+        const __m256i wide = _mm256_broadcastsi128_si256(broadcastSse2(value));
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {
+            const __m256i* p = reinterpret_cast<const __m256i*>(data + i);
+            int hit = compareAvx2<U>(_mm256_loadu_si256(p), wide) | compareAvx2<U>(_mm256_loadu_si256(p + 1), wide)
+                | compareAvx2<U>(_mm256_loadu_si256(p + 2), wide) | compareAvx2<U>(_mm256_loadu_si256(p + 3), wide);
+            if (hit != 0) {
+                return true;
+            }
+        }
+#elif defined(CPPTF_SEARCH_SSE2)
+        constexpr std::size_t lanes = 16 / sizeof(U);
+        const __m128i needle = broadcastSse2(value);
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {
+            const __m128i* p = reinterpret_cast<const __m128i*>(data + i);
+            int hit = compareSse2<U>(_mm_loadu_si128(p), needle) | compareSse2<U>(_mm_loadu_si128(p + 1), needle)
+                | compareSse2<U>(_mm_loadu_si128(p + 2), needle) | compareSse2<U>(_mm_loadu_si128(p + 3), needle);
+            if (hit != 0) {
+                return true;
+            }
+        }
+#endif
+    }
+    return blockContains(data + i, count - i, value);
+}
+
+template <typename Container, typename Value>
+bool containerContains(const Container& container, const Value& value) {
+    using Element = std::remove_cv_t<std::ranges::range_value_t<const Container>>;
+
+    if constexpr (std::is_convertible_v<const Container&, std::string_view> && std::is_convertible_v<const Value&, std::string_view>) {
+        return std::string_view(container).find(std::string_view(value)) != std::string_view::npos;
+    }
+    else if constexpr (requires { { container.contains(value) } -> std::convertible_to<bool>; }) {
+        return container.contains(value);
+    }
+    else if constexpr (requires { { container.find(value) == container.end() } -> std::convertible_to<bool>; }) {
+        return container.find(value) != container.end();
+    }
+    else if constexpr (std::ranges::contiguous_range<const Container> && std::is_same_v<Element, Value> && cpptf_search_detail::simdSearchable<Element>) {
+        return simdContains(std::ranges::data(container), std::ranges::size(container), value);
+    }
+    else {
+        for (const auto& item : container) {
+            if (item == value) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
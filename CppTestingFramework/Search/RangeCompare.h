@@ -0,0 +1,207 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<cmath>
+#include<span>
+#include<vector>
+#include<limits>
+#include<algorithm>
+#include<type_traits>
+#include "ContainerSearch.h"
+
+// Element-wise comparison of two contiguous ranges for assertRangeEqual / assertAllEqual / assertAllNear.
+// The ranges are walked in blocks; a block is first checked with SIMD compares ("does every lane match?")
+// and only blocks that contain a mismatch are rescanned element by element.
+
+// Floating point closeness: a pair is near when ANY of the enabled tolerances accepts it
+struct FloatTolerance {
+    double absolute = 0.0;        // |a - b| <= absolute
+    double relative = 0.0;        // |a - b| <= relative * max(|a|, |b|)
+    std::uint64_t ulps = 0;       // at most this many representable values apart
+
+    static FloatTolerance absoluteOf(double epsilon) { FloatTolerance t; t.absolute = epsilon; return t; }
+    static FloatTolerance relativeOf(double fraction) { FloatTolerance t; t.relative = fraction; return t; }
+    static FloatTolerance ulpsOf(std::uint64_t count) { FloatTolerance t; t.ulps = count; return t; }
+};
+
+struct RangeComparison {
+    std::size_t compared = 0;
+    std::size_t mismatches = 0;
+    std::vector<std::size_t> firstMismatches;  // at most maxReported indices, only allocated on failure
+
+    bool passed() const { return mismatches == 0; }
+};
+
+namespace cpptf_range_detail {
+    constexpr std::size_t blockSize = 256;
+
+    // Distance in representable values; maps the float bit pattern onto a monotonic integer line
+    template <typename F>
+    std::uint64_t ulpDistance(F a, F b) {
+        using Bits = std::conditional_t<sizeof(F) == 4, std::int32_t, std::int64_t>;
+        Bits ia;
+        Bits ib;
+        std::memcpy(&ia, &a, sizeof(F));
+        std::memcpy(&ib, &b, sizeof(F));
+        if (ia < 0) ia = std::numeric_limits<Bits>::min() - ia;
+        if (ib < 0) ib = std::numeric_limits<Bits>::min() - ib;
+        return ia > ib ? static_cast<std::uint64_t>(ia) - static_cast<std::uint64_t>(ib)
+                       : static_cast<std::uint64_t>(ib) - static_cast<std::uint64_t>(ia);
+    }
+
+    template <typename F>
+    bool isNear(F a, F b, const FloatTolerance& tolerance) {
+        if (a == b) {
+            return true;
+        }
+        if (std::isnan(a) || std::isnan(b)) {
+            return false;
+        }
+        const double difference = std::fabs(static_cast<double>(a) - static_cast<double>(b));
+        if (difference <= tolerance.absolute) {
+            return true;
+        }
+        if (difference <= tolerance.relative * std::max(std::fabs(static_cast<double>(a)), std::fabs(static_cast<double>(b)))) {
+            return true;
+        }
+        return tolerance.ulps > 0 && !std::isinf(a) && !std::isinf(b) && ulpDistance(a, b) <= tolerance.ulps;
+    }
+
+    // true when every element of the block matches exactly (SIMD for arithmetic types)
+    template <typename U>
+    bool blockEqual(const U* a, const U* b, std::size_t count) {
+        std::size_t i = 0;
+        if constexpr (cpptf_search_detail::simdSearchable<U>) {
+#if defined(CPPTF_SEARCH_AVX2)
+            constexpr std::size_t lanes = 32 / sizeof(U);
+            for (; i + lanes <= count; i += lanes) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                if (cpptf_search_detail::compareAvx2<U>(x, y) != cpptf_search_detail::fullMaskAvx2<U>()) {
+                    return false;
+                }
+            }
+#elif defined(CPPTF_SEARCH_SSE2)
+            constexpr std::size_t lanes = 16 / sizeof(U);
+            for (; i + lanes <= count; i += lanes) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                if (cpptf_search_detail::compareSse2<U>(x, y) != cpptf_search_detail::fullMaskSse2<U>()) {
+                    return false;
+                }
+            }
+#endif
+        }
+        bool equal = true;
+        for (; i < count; ++i) {
+            equal &= static_cast<bool>(a[i] == b[i]);
+        }
+        return equal;
+    }
+
+    // true when every pair of the block is within the absolute or relative tolerance (SIMD for float/double).
+    // Returning false only means "rescan this block", the ULP rule is applied there.
+    template <typename F>
+    bool blockNear(const F* a, const F* b, std::size_t count, const FloatTolerance& tolerance) {
+        std::size_t i = 0;
+#if defined(CPPTF_SEARCH_SSE2)
+        // Same precision as isNear: floats are widened to double before subtracting, so the SIMD path accepts
+        // exactly the pairs the scalar rule accepts
+        const __m128d signMask = _mm_set1_pd(-0.0);
+        const __m128d absolute = _mm_set1_pd(tolerance.absolute);
+        const __m128d relative = _mm_set1_pd(tolerance.relative);
+        auto nearMask = [&](__m128d x, __m128d y) {
+            __m128d difference = _mm_andnot_pd(signMask, _mm_sub_pd(x, y));
+            __m128d scale = _mm_max_pd(_mm_andnot_pd(signMask, x), _mm_andnot_pd(signMask, y));
+            __m128d ok = _mm_or_pd(_mm_cmpeq_pd(x, y),
+                _mm_or_pd(_mm_cmple_pd(difference, absolute), _mm_cmple_pd(difference, _mm_mul_pd(relative, scale))));
+            return _mm_movemask_pd(ok);
+        };
+        if constexpr (std::is_same_v<F, float>) {
+            for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_loadu_ps(a + i);
+                __m128 y = _mm_loadu_ps(b + i);
+                if (nearMask(_mm_cvtps_pd(x), _mm_cvtps_pd(y)) != 0x3
+                    || nearMask(_mm_cvtps_pd(_mm_movehl_ps(x, x)), _mm_cvtps_pd(_mm_movehl_ps(y, y))) != 0x3) {
+                    return false;
+                }
+            }
+        }
+        else if constexpr (std::is_same_v<F, double>) {
+            for (; i + 2 <= count; i += 2) {
+                if (nearMask(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)) != 0x3) {
+                    return false;
+                }
+            }
+        }
+#endif
+        bool near = true;
+        for (; i < count; ++i) {
+            near &= isNear(a[i], b[i], tolerance);
+        }
+        return near;
+    }
+
+    template <typename U, typename BlockOk, typename ElementOk>
+    RangeComparison compare(std::span<const U> actual, std::span<const U> expected, std::size_t maxReported,
+        BlockOk&& blockOk, ElementOk&& elementOk) {
+        RangeComparison result;
+        result.compared = std::min(actual.size(), expected.size());
+
+        for (std::size_t begin = 0; begin < result.compared; begin += blockSize) {
+            const std::size_t count = std::min(blockSize, result.compared - begin);
+            if (blockOk(actual.data() + begin, expected.data() + begin, count)) {
+                continue;
+            }
+            for (std::size_t i = begin; i < begin + count; ++i) {
+                if (!elementOk(actual[i], expected[i])) {
+                    if (result.firstMismatches.size() < maxReported) {
+                        result.firstMismatches.push_back(i);
+                    }
+                    ++result.mismatches;
+                }
+            }
+        }
+        return result;
+    }
+}
+
+template <typename U>
+RangeComparison compareRanges(std::span<const U> actual, std::span<const U> expected, std::size_t maxReported) {
+    return cpptf_range_detail::compare(actual, expected, maxReported,
+        [](const U* a, const U* b, std::size_t count) { return cpptf_range_detail::blockEqual(a, b, count); },
+        [](const U& a, const U& b) { return static_cast<bool>(a == b); });
+}
+
+// Every element of actual against one value
+template <typename U>
+RangeComparison compareRangeToValue(std::span<const U> actual, const U& expected, std::size_t maxReported) {
+    if constexpr (cpptf_search_detail::simdSearchable<U>) {
+        // Run the two-range kernel against a block-sized run of the expected value
+        U pattern[cpptf_range_detail::blockSize];
+        std::fill(std::begin(pattern), std::end(pattern), expected);
+
+        return cpptf_range_detail::compare(actual, actual, maxReported,
+            [&pattern](const U* a, const U*, std::size_t count) { return cpptf_range_detail::blockEqual(a, pattern, count); },
+            [&expected](const U& a, const U&) { return a == expected; });
+    }
+    else {
+        return cpptf_range_detail::compare(actual, actual, maxReported,
+            [&expected](const U* a, const U*, std::size_t count) {
+                bool equal = true;
+                for (std::size_t i = 0; i < count; ++i) {
+                    equal &= static_cast<bool>(a[i] == expected);
+                }
+                return equal;
+            },
+            [&expected](const U& a, const U&) { return static_cast<bool>(a == expected); });
+    }
+}
+
+template <typename F>
+RangeComparison compareRangesNear(std::span<const F> actual, std::span<const F> expected, const FloatTolerance& tolerance, std::size_t maxReported) {
+    return cpptf_range_detail::compare(actual, expected, maxReported,
+        [&tolerance](const F* a, const F* b, std::size_t count) { return cpptf_range_detail::blockNear(a, b, count, tolerance); },
+        [&tolerance](const F& a, const F& b) { return cpptf_range_detail::isNear(a, b, tolerance); });
+}
@@ -0,0 +1,27 @@
+// SelfRegisteredTests.cpp : tests that register themselves, nothing here is called from main()
+//
+
+#include "./UnitTest/UnitTest.h"
+
+#include <string>
+#include <vector>
+
+
+TEST(Strings, concatenation) {
+    return UnitTest<std::string>::getInstance().assertEqual(std::string("ab") + "cd", "abcd");
+}
+
+TEST_TAGGED(Strings, size, "fast") {
+    return UnitTest<std::size_t>::getInstance().assertEqual(std::string("hello").size(), 5);
+}
+
+TEST(Vectors, pushBack) {
+    std::vector<int> values{ 1, 2 };
+    values.push_back(3);
+    return UnitTest<std::vector<int>>::getInstance().assertEqual(values, { 1, 2, 3 });
+}
+
+SERIAL_TEST(Vectors, wrongSize) {
+    std::vector<int> values(3);
+    return UnitTest<std::size_t>::getInstance().assertEqual(values.size(), 4);  // Fail
+}
@@ -0,0 +1,261 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<atomic>
+#include<barrier>
+#include<thread>
+#include<chrono>
+#include<ostream>
+#include<exception>
+#include<algorithm>
+#include<type_traits>
+#include "../Property/Property.h"
+
+// Stress runs for concurrent code: one body runs on options.threads threads at once, options.iterations
+// times on each, to flush out races that a single call on a single thread never hits.
+//
+// All threads are released together by a start barrier, and every options.roundLength iterations they meet
+// again at a round barrier, where the optional quiescent check runs while no body is in flight (the place to
+// verify invariants such as "pushed - popped == size"). Between iterations, and wherever the body calls
+// StressContext::yield(), a thread randomly yields or spins to shake up the interleaving.
+//
+// Failures (the body returned false or threw) and invariant violations (StressContext::check and the
+// quiescent check) go to shared atomic counters; the first of them also wins a compare-exchange that keeps
+// its thread, iteration and message for the report.
+//
+// Thread t draws its yields, and anything the body takes from context.rng, from the stream (seed, t), so a
+// seed from a failure report replays the same per-thread decisions. The OS scheduler still has the last
+// word on the interleaving: replay makes a race as likely again, not certain.
+
+struct StressOptions {
+    std::size_t threads = 0;            // 0 = hardware concurrency, at least 2
+    std::size_t iterations = 10000;     // per thread
+    std::size_t roundLength = 0;        // iterations between round barriers, 0 = only the start barrier
+    std::uint64_t seed = 0;             // 0 = pick a fresh seed, reported with the result
+    unsigned yieldOneIn = 8;            // a yield point perturbs the schedule with probability 1/yieldOneIn, 0 = never
+    std::size_t maxSpin = 256;          // longest busy wait of a perturbation, in pause iterations
+    bool stopOnFailure = false;         // let every thread stop at its next iteration after the first failure
+};
+
+struct StressResult {
+    bool passed = true;
+    std::uint64_t seed = 0;
+    std::size_t threads = 0;
+    std::size_t iterationsRun = 0;      // over all threads
+    std::size_t failures = 0;
+    std::size_t violations = 0;
+    std::size_t rounds = 0;             // quiescent checks run
+    std::size_t firstThread = 0;        // first recorded failure or violation
+    std::size_t firstIteration = 0;
+    std::string firstWhat;
+    std::chrono::nanoseconds elapsed{ 0 };
+};
+
+namespace cpptf_stress_detail {
+    constexpr std::uint64_t none = static_cast<std::uint64_t>(-1);
+
+    constexpr std::size_t quiescentThread = 0xFFFF;  // StressResult::firstThread of a failed quiescent check
+
+    // State shared by all threads of one run
+    struct Shared {
+        std::atomic<std::size_t> failures{ 0 };
+        std::atomic<std::size_t> violations{ 0 };
+        std::atomic<std::size_t> rounds{ 0 };
+        std::atomic<bool> stop{ false };
+        std::atomic<std::uint64_t> first{ none };   // thread in the low 16 bits, iteration above
+        std::string firstWhat;                      // only written by the thread that set first, read after the join
+        bool stopOnFailure = false;
+
+        void record(std::size_t thread, std::size_t iteration, std::string_view what, std::atomic<std::size_t>& counter) {
+            counter.fetch_add(1, std::memory_order_relaxed);
+            std::uint64_t expected = none;
+            if (first.load(std::memory_order_relaxed) == none
+                && first.compare_exchange_strong(expected, (static_cast<std::uint64_t>(iteration) << 16) | thread, std::memory_order_relaxed)) {
+                firstWhat = what;
+            }
+            if (stopOnFailure) {
+                stop.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    inline void pause() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+}
+
+// Handed to the body on every iteration
+class StressContext {
+private:
+    cpptf_stress_detail::Shared* shared;
+    unsigned yieldOneIn;
+    std::size_t maxSpin;
+
+public:
+    StressContext(cpptf_stress_detail::Shared& shared, std::size_t thread, std::uint64_t seed, const StressOptions& options)
+        : shared(&shared), yieldOneIn(options.yieldOneIn), maxSpin(options.maxSpin), thread(thread), rng(PropertyRng::forCase(seed, thread)) {}
+
+    const std::size_t thread;
+    std::size_t iteration = 0;
+    PropertyRng rng;                    // this thread's stream of the run's seed, for inputs the body needs
+
+    // Counts an invariant violation when condition is false; the iteration goes on
+    bool check(bool condition, std::string_view what = "invariant violated") {
+        if (!condition) {
+            shared->record(thread, iteration, what, shared->violations);
+        }
+        return condition;
+    }
+
+    // Random perturbation point: nothing, a yield, or a short busy wait. Put it inside a critical window
+    // (between a load and the store that depends on it) to make a race there far more likely to show.
+    void yield() {
+        if (yieldOneIn == 0 || !rng.chance(yieldOneIn)) {
+            return;
+        }
+        if (maxSpin == 0 || rng.chance(2)) {
+            std::this_thread::yield();
+            return;
+        }
+        for (std::uint64_t spin = rng.below(maxSpin) + 1; spin > 0; --spin) {
+            cpptf_stress_detail::pause();
+        }
+    }
+};
+
+// Quiescent check that checks nothing
+struct StressNoCheck {
+    bool operator()() const { return true; }
+};
+
+// Run body(StressContext&) concurrently; it returns whether the iteration passed (or nothing, and then only
+// exceptions fail it). quiescent() runs on one thread at every round barrier and after the last iteration.
+template <typename Body, typename Check = StressNoCheck>
+StressResult runStress(Body&& body, const StressOptions& options = {}, Check&& quiescent = {}) {
+    using cpptf_stress_detail::Shared;
+    StressResult result;
+    result.seed = options.seed != 0 ? options.seed : cpptf_property_detail::freshSeed();
+    result.threads = options.threads != 0 ? options.threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+    result.threads = std::min<std::size_t>(result.threads, cpptf_stress_detail::quiescentThread);
+
+    Shared shared;
+    shared.stopOnFailure = options.stopOnFailure;
+    std::vector<std::size_t> iterationsRun(result.threads, 0);   // slot t is only written by thread t
+
+    // Every thread is parked here (or gone) when the completion runs, so the check sees a quiescent structure.
+    // The last phase completes when the final thread drops out after its last iteration.
+    struct Completion {
+        Shared* shared;
+        std::remove_reference_t<Check>* check;
+        bool started = false;
+        void operator()() noexcept {
+            if (!started) {
+                started = true;  // the start barrier
+                return;
+            }
+            shared->rounds.fetch_add(1, std::memory_order_relaxed);
+            bool holds = false;
+            try {
+                holds = static_cast<bool>((*check)());
+            }
+            catch (...) {
+            }
+            if (!holds) {
+                shared->record(cpptf_stress_detail::quiescentThread, shared->rounds.load(std::memory_order_relaxed), "quiescent check failed", shared->violations);
+            }
+        }
+    };
+    std::barrier<Completion> barrier(static_cast<std::ptrdiff_t>(result.threads), Completion{ &shared, &quiescent });
+
+    auto worker = [&](std::size_t thread) {
+        StressContext context(shared, thread, result.seed, options);
+        barrier.arrive_and_wait();
+        std::size_t i = 0;
+        for (; i < options.iterations && !shared.stop.load(std::memory_order_relaxed); ++i) {
+            context.iteration = i;
+            bool passed = true;
+            std::string exception;
+            try {
+                if constexpr (std::is_void_v<decltype(body(context))>) {
+                    body(context);
+                }
+                else {
+                    passed = static_cast<bool>(body(context));
+                }
+            }
+            catch (const std::exception& error) {
+                passed = false;
+                exception = std::string("threw: ") + error.what();
+            }
+            catch (...) {
+                passed = false;
+                exception = "threw: unknown exception";
+            }
+            if (!passed) {
+                shared.record(thread, i, exception.empty() ? std::string_view("body failed") : std::string_view(exception), shared.failures);
+            }
+            context.yield();
+            if (options.roundLength != 0 && (i + 1) % options.roundLength == 0 && i + 1 < options.iterations) {
+                barrier.arrive_and_wait();
+            }
+        }
+        iterationsRun[thread] = i;
+        // Leaving early (stopOnFailure) must not strand the others at a round barrier
+        barrier.arrive_and_drop();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(result.threads - 1);
+        for (std::size_t t = 1; t < result.threads; ++t) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+    }
+    result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    for (std::size_t run : iterationsRun) {
+        result.iterationsRun += run;
+    }
+    result.failures = shared.failures.load();
+    result.violations = shared.violations.load();
+    result.rounds = shared.rounds.load();
+    result.passed = result.failures == 0 && result.violations == 0;
+    const std::uint64_t first = shared.first.load();
+    if (first != cpptf_stress_detail::none) {
+        result.firstThread = static_cast<std::size_t>(first & 0xFFFF);
+        result.firstIteration = static_cast<std::size_t>(first >> 16);
+        result.firstWhat = std::move(shared.firstWhat);
+    }
+    return result;
+}
+
+// "8 threads x 10000 iterations held (seed 0x...)" or the counts and the first failure with its seed
+inline void describeStressResult(std::ostream& os, const StressResult& result) {
+    const auto flags = os.flags();
+    const std::size_t perThread = result.threads != 0 ? result.iterationsRun / result.threads : 0;
+    if (result.passed) {
+        os << result.threads << " threads x " << perThread << " iterations held, " << result.rounds << " quiescent checks (seed 0x"
+            << std::hex << result.seed << ')';
+        os.flags(flags);
+        return;
+    }
+    os << result.failures << " failures, " << result.violations << " invariant violations in " << result.iterationsRun
+        << " iterations on " << result.threads << " threads (seed 0x" << std::hex << result.seed << std::dec << "), first ";
+    if (result.firstThread == cpptf_stress_detail::quiescentThread) {
+        os << "at quiescent check #" << result.firstIteration;
+    }
+    else {
+        os << "on thread " << result.firstThread << " at iteration " << result.firstIteration;
+    }
+    os << ": " << result.firstWhat;
+    os.flags(flags);
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include<vector>
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<functional>
+#include<memory>
+#include<exception>
+#include<algorithm>
+#include<utility>
+
+// Work-stealing thread pool.
+// Every worker owns its own task queue: it pops work from the back of its own queue
+// and, once that is empty, steals from the front of the other workers' queues.
+// There is no global queue lock, only one small lock per worker queue.
+class ThreadPool {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // workerCount == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(std::size_t workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    // Queue a task. Tasks submitted from one of our workers go to that worker's queue.
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished. Rethrows the first exception a task threw.
+    // Must not be called from inside a task of the same pool.
+    void wait();
+
+    // Run body(index, workerIndex) for every index in [0, count) and wait for completion.
+    // grainSize == 0 picks a chunk size that gives every worker several chunks to steal.
+    template <typename Body>
+    void parallelFor(std::size_t count, Body&& body, std::size_t grainSize = 0);
+
+    // Index of the calling worker inside this pool, npos if the caller is not one of its workers
+    std::size_t currentWorkerIndex() const;
+
+    // Worker threads alive in all pools of the process; fork() is only safe while this is 0
+    static std::size_t runningWorkers() { return liveWorkers.load(std::memory_order_acquire); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<std::size_t> queued{ 0 };   // tasks sitting in a queue
+    std::atomic<std::size_t> pending{ 0 };  // tasks queued or running
+    std::atomic<std::size_t> nextQueue{ 0 };
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    bool stopping = false;
+    std::exception_ptr firstError;
+
+    inline static std::atomic<std::size_t> liveWorkers{ 0 };
+    inline static thread_local const ThreadPool* ownerPool = nullptr;
+    inline static thread_local std::size_t ownerIndex = npos;
+
+    void workerLoop(std::size_t index);
+    bool tryPop(std::size_t index, std::function<void()>& task);
+    void finishTask();
+};
+
+
+inline ThreadPool::ThreadPool(std::size_t workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    queues.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    workers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+        liveWorkers.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+        liveWorkers.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+inline std::size_t ThreadPool::currentWorkerIndex() const {
+    return ownerPool == this ? ownerIndex : npos;
+}
+
+inline void ThreadPool::submit(std::function<void()> task) {
+    std::size_t target = currentWorkerIndex();
+    if (target == npos) {
+        target = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+        queued.fetch_add(1, std::memory_order_release);
+    }
+
+    // Taking the state lock here closes the window between a worker's predicate check and its sleep
+    { std::lock_guard<std::mutex> lock(stateMutex); }
+    workAvailable.notify_one();
+}
+
+inline void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this]() { return pending.load(std::memory_order_acquire) == 0; });
+
+    if (firstError) {
+        std::exception_ptr error = std::exchange(firstError, nullptr);
+        lock.unlock();
+        std::rethrow_exception(error);
+    }
+}
+
+template <typename Body>
+void ThreadPool::parallelFor(std::size_t count, Body&& body, std::size_t grainSize) {
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        grainSize = std::max<std::size_t>(1, count / (size() * 8));
+    }
+
+    for (std::size_t begin = 0; begin < count; begin += grainSize) {
+        std::size_t end = std::min(count, begin + grainSize);
+        submit([this, &body, begin, end]() {
+            std::size_t worker = currentWorkerIndex();
+            for (std::size_t i = begin; i < end; ++i) {
+                body(i, worker);
+            }
+            });
+    }
+    wait();
+}
+
+inline bool ThreadPool::tryPop(std::size_t index, std::function<void()>& task) {
+    // Own queue first, newest task (still warm in cache)
+    {
+        WorkQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest task of another worker
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void ThreadPool::finishTask() {
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        { std::lock_guard<std::mutex> lock(stateMutex); }
+        allDone.notify_all();
+    }
+}
+
+inline void ThreadPool::workerLoop(std::size_t index) {
+    ownerPool = this;
+    ownerIndex = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (tryPop(index, task)) {
+            try {
+                task();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+            task = nullptr;
+            finishTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this]() {
+            return stopping || queued.load(std::memory_order_acquire) > 0;
+            });
+        if (stopping && queued.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+    }
+
+    ownerPool = nullptr;
+    ownerIndex = npos;
+}
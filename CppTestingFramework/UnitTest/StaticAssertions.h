@@ -0,0 +1,110 @@
+#pragma once
+#include<tuple>
+#include<type_traits>
+#include<utility>
+#include<cstddef>
+#include<string>
+#include "TestSummary.h"
+#include "../Registry/TestRegistry.h"
+#include "../Reporter/Reporter.h"
+
+// Statically typed alternative to UnitTest<T>::addAssertion.
+// Every assertion keeps its exact callable and argument types, and the whole set lives in one std::tuple:
+// no std::function, no heap allocation per assertion and no indirect call when running them.
+// Arguments are owned (moved in), so std::make_unique<X>(...) replaces the leaking `new X(...)` pattern.
+
+// Pointer-like arguments (raw or smart pointers) are dereferenced for member function assertions,
+// which is what addAssertion did with (*args)...; plain values are passed as they are.
+template <typename U>
+decltype(auto) unwrapArgument(U& value) {
+    if constexpr (std::is_pointer_v<U> || requires { value.get(); *value; }) {
+        return *value;
+    }
+    else {
+        return (value);
+    }
+}
+
+// One assertion together with its owned arguments
+template <typename Func, typename... Args>
+class BoundAssertion {
+private:
+    Func func;
+    std::tuple<Args...> arguments;
+
+public:
+    template <typename F, typename... A>
+    explicit BoundAssertion(F&& f, A&&... args)
+        : func(std::forward<F>(f)), arguments(std::forward<A>(args)...) {
+    }
+
+    // suite is only used when func is a member function pointer of it (e.g. &UnitTest<T>::assertEqual)
+    template <typename Suite>
+    bool operator()(Suite& suite) {
+        return std::apply([this, &suite](Args&... args) -> bool {
+            if constexpr (std::is_member_function_pointer_v<Func>) {
+                return static_cast<bool>((suite.*func)(unwrapArgument(args)...));
+            }
+            else {
+                return static_cast<bool>(func(args...));
+            }
+            }, arguments);
+    }
+};
+
+template <typename Func, typename... Args>
+BoundAssertion<std::decay_t<Func>, std::decay_t<Args>...> bindAssertion(Func&& func, Args&&... args) {
+    return BoundAssertion<std::decay_t<Func>, std::decay_t<Args>...>(std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+// Fixed set of bound assertions for one suite, see UnitTest<T>::makeStaticAssertions
+template <typename Suite, typename... Bound>
+class StaticAssertions {
+private:
+    Suite* suite;
+    std::tuple<Bound...> assertions;
+
+    template <std::size_t I>
+    static bool invokeAt(void* self, std::size_t) {
+        StaticAssertions& owner = *static_cast<StaticAssertions*>(self);
+        return std::get<I>(owner.assertions)(*owner.suite);
+    }
+
+    template <std::size_t... I>
+    void registerAll(TestRegistry& registry, const char* suiteName, const char* kind, bool serial, std::index_sequence<I...>) {
+        (registry.add({ &StaticAssertions::invokeAt<I>, this, I, suiteName, serial, kind }), ...);
+    }
+
+public:
+    template <typename... B>
+    explicit StaticAssertions(Suite& suite, B&&... bound) : suite(&suite), assertions(std::forward<B>(bound)...) {}
+
+    static constexpr std::size_t size() { return sizeof...(Bound); }
+
+    // Runs every assertion in order; the fold expression calls each one directly
+    TestSummary run() {
+        Reporter& reporter = Reporter::current();
+        reporter.beginRun();
+
+        TestSummary summary;
+        std::apply([this, &summary](Bound&... bound) {
+            (summary.record(bound(*suite)), ...);
+            }, assertions);
+
+        reporter.endRun(summary);
+        return summary;
+    }
+
+    // Adds one TestRegistry entry per assertion (a per-index function pointer, no std::function).
+    // This object must stay alive and must not move while the registry can still run it.
+    // Entries are keyed "suite#staticN:I", N counting the sets registered for the suite (in registration order).
+    void registerWith(TestRegistry& registry, bool serial = false) {
+        const char* suiteName = "StaticAssertions";
+        if constexpr (requires { Suite::typeName().c_str(); }) {
+            suiteName = Suite::typeName().c_str();
+        }
+        const std::size_t set = registry.nextSequence(suiteName, "static");
+        const char* kind = registry.intern("static" + std::to_string(set));
+        registerAll(registry, suiteName, kind, serial, std::index_sequence_for<Bound...>{});
+    }
+};
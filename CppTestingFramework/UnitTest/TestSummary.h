@@ -0,0 +1,30 @@
+#pragma once
+#include<cstddef>
+
+// Pass/fail tally of a test run
+struct TestSummary {
+    std::size_t passed = 0;
+    std::size_t failed = 0;
+
+    std::size_t total() const { return passed + failed; }
+
+    void record(bool result) {
+        if (result) {
+            ++passed;
+        }
+        else {
+            ++failed;
+        }
+    }
+
+    TestSummary& operator+=(const TestSummary& other) {
+        passed += other.passed;
+        failed += other.failed;
+        return *this;
+    }
+};
+
+// Per-worker tally, padded to its own cache line so workers never share one while counting
+struct alignas(64) WorkerTally {
+    TestSummary summary;
+};
@@ -1,10 +1,37 @@
-﻿#pragma once
+#pragma once
 #include<vector>
 #include<concepts>
 #include<iostream>
 #include <type_traits>
 #include<functional>
+#include<atomic>
+#include<string>
+#include<string_view>
+#include<typeinfo>
+#include<cstdint>
+#include<span>
+#include<limits>
 #include "../FunctionWrapper/FunctionWrapper.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "../Registry/TestRegistry.h"
+#include "../Registry/AutoRegistration.h"
+#include "../Reporter/Reporter.h"
+#include "../Benchmark/Benchmark.h"
+#include "../Benchmark/Baseline.h"
+#include "../AllocationTracker/AllocationTracker.h"
+#include "../Search/ContainerSearch.h"
+#include "../Search/RangeCompare.h"
+#include "TestSummary.h"
+#include "StaticAssertions.h"
+#include "../Arena/MonotonicArena.h"
+#include "../Watchdog/Watchdog.h"
+#include "../Profiler/TimingRecorder.h"
+#include "../Async/EventLoop.h"
+#include "../Parameterized/Generators.h"
+#include "../Property/Property.h"
+#include "../Stress/Stress.h"
+#include "../Fixture/Fixture.h"
+#include "../Diff/ValueDiff.h"
 
 // Concept definition for checking if T has operator==
 template <typename U>
@@ -28,14 +55,69 @@ template <typename U>
 concept HasConstIterator = requires { typename U::const_iterator; };
 
 
+namespace cpptf_parameter_detail {
+    template <typename U>
+    concept TupleLike = requires { std::tuple_size<std::remove_cvref_t<U>>::value; };
+
+    // A tuple case is unpacked into separate arguments when func takes them that way
+    template <typename Func, typename Case>
+    decltype(auto) invokeCase(Func& func, Case&& value) {
+        if constexpr (TupleLike<Case>) {
+            if constexpr (requires { std::apply(func, std::forward<Case>(value)); }) {
+                return std::apply(func, std::forward<Case>(value));
+            }
+            else {
+                return func(std::forward<Case>(value));
+            }
+        }
+        else {
+            return func(std::forward<Case>(value));
+        }
+    }
+}
+
 template <typename T>
 class UnitTest {
 private:
     static UnitTest<T>* instance;
-    static int instanceCounter;
+    // Only counted while diagnostics are on, relaxed atomics since it is pure bookkeeping
+    static std::atomic<std::size_t> instanceCounter;
+    static std::atomic<bool> diagnosticsEnabled;
 
 public: //change to private when solved storing assertion function fully required
     std::vector<std::function<bool()>> assertions;
+    // Assertions that must not run concurrently with anything else (runTestsParallel runs them last, on the calling thread)
+    std::vector<std::function<bool()>> serialAssertions;
+
+private:
+    // Assertions whose closure and arguments live in assertionArena (see addArenaAssertion)
+    struct ArenaAssertion {
+        bool (*invoke)(void* closure, UnitTest<T>& suite);
+        void* closure;
+    };
+    MonotonicArena assertionArena;
+    std::vector<ArenaAssertion> arenaAssertions;
+
+    TimeoutOptions timeouts;
+    DiffOptions diffs;
+
+    // Parameterized tables: one closure (generator + test function) per table in parameterArena,
+    // split into batches of cases that are scheduled like single assertions
+    struct ParameterizedTable {
+        bool (*runCases)(void* closure, std::size_t begin, std::size_t end, TestSummary& summary);
+        void* closure;
+    };
+    struct ParameterBatch {
+        std::size_t table;
+        std::size_t begin;
+        std::size_t end;
+    };
+    MonotonicArena parameterArena;
+    std::vector<ParameterizedTable> parameterizedTables;
+    std::vector<ParameterBatch> parameterBatches;
+
+    // Factories of the coroutine assertions; the closures stay here while their coroutines run
+    std::vector<std::function<AsyncAssertion()>> asyncAssertions;
 
 private:
     // Private copy constructor and assignment operator to prevent copying
@@ -47,16 +129,178 @@ protected:
 
     }
     
-    void printResult(bool passed, const T& testObject, const T& trueObject, const std::string& functionName = "");
+    // shouldBeEqual: the assertion expects the values to be equal, so a failure is explained by a diff
+    void printResult(bool passed, const T& testObject, const T& trueObject, std::string_view functionName = "", bool shouldBeEqual = false);
+
+    // Caller supplied name, or the assertion's own name when none was given
+    static std::string_view nameOr(const std::string& functionName, std::string_view fallback) {
+        return functionName.empty() ? fallback : std::string_view(functionName);
+    }
+
+private:
+    struct ComparedValues {
+        bool passed;
+        const T* testObject;
+        const T* trueObject;
+        const DiffOptions* diff;
+        bool shouldBeEqual;     // only then does a failure get a diff
+    };
+
+    // AssertionResult::describe callbacks, only invoked when the reporter keeps the result
+    static void describeValues(std::ostream& os, const void* context);
+    static void describeBoolean(std::ostream& os, const void* context);
+
+    struct TimingComparison {
+        double medianNs;
+        double referenceNs;     // limit or baseline median, 0 when there was no baseline yet
+        double pValue;          // < 0 when no statistical test was made
+        bool againstBaseline;
+    };
+    static void describeTiming(std::ostream& os, const void* context);
+    void reportTiming(bool passed, std::string_view functionName, const TimingComparison& timing);
+
+    struct AllocationCheck {
+        const AllocationCounters* counted;
+        std::size_t maxCount;
+        std::size_t maxBytes;
+    };
+    static void describeAllocations(std::ostream& os, const void* context);
+
+    // FunctionWrapper-like objects are run through call(), everything else is called directly
+    template <typename Func>
+    static void invokeCallable(Func& func);
+
+    struct Membership {
+        const T* value;
+        bool found;
+    };
+    static void describeMembership(std::ostream& os, const void* context);
+    void reportMembership(bool passed, const T& testObject, bool found, std::string_view functionName);
+
+    struct RangeReport {
+        const RangeComparison* comparison;
+        std::span<const T> actual;
+        std::span<const T> expected;   // empty for assertAllEqual
+        const T* expectedValue;        // only for assertAllEqual
+    };
+    static void describeRange(std::ostream& os, const void* context);
+    void reportRange(bool passed, std::string_view functionName, const RangeReport& report);
+
+    // Below this p-value a slowdown beyond the tolerance counts as a real regression, not noise
+    static constexpr double regressionSignificance = 0.01;
+
+protected:
 
 public:
-    void runTests();
+    TestSummary runTests();
+
+    // Run the stored assertions on a work-stealing pool, workerCount == 0 uses every hardware thread
+    TestSummary runTestsParallel(std::size_t workerCount = 0);
+    TestSummary runTestsParallel(ThreadPool& pool);
+
+    // Per-assertion / per-suite time limits for runTests and runTestsParallel (see Watchdog.h); off by default
+    void setTimeouts(const TimeoutOptions& options) { timeouts = options; }
+    const TimeoutOptions& timeoutOptions() const { return timeouts; }
+
+    // Size limits of the failure diffs printed by assertEqual for strings and containers (see ValueDiff.h)
+    void setDiffOptions(const DiffOptions& options) { diffs = options; }
+    const DiffOptions& diffOptions() const { return diffs; }
+
     static UnitTest<T>& getInstance();
+
+    // Opt-in: log every getInstance() call with a running count (off by default)
+    static void setDiagnostics(bool enabled);
+    static std::size_t instanceCount();
+
+    // typeid(T).name(), built once per type
+    static const std::string& typeName();
     
     // Add assertion to the list (wrap it as a lambda)
     template <typename Func, typename... Args>
     void addAssertion(Func&& func,  Args&&... args);
 
+    // Same as addAssertion, but the assertion is never run concurrently with other assertions
+    template <typename Func, typename... Args>
+    void addSerialAssertion(Func&& func, Args&&... args);
+
+    // Coroutine assertion: func(args...) returns an AsyncAssertion (see EventLoop.h). runTests, and runAll for
+    // the selected ones, run all of them together on one event loop under the suite's TimeoutOptions.
+    template <typename Func, typename... Args>
+    void addAsyncAssertion(Func&& func, Args&&... args);
+
+    // Data-driven test: func is called once per case of generator (see Generators.h), with a tuple case
+    // unpacked into separate arguments. Cases are built lazily while their batch runs; each batch of
+    // batchSize cases is one unit of work for runTestsParallel and one TestRegistry entry.
+    template <CaseGenerator Generator, typename Func>
+    void addParameterized(Generator&& generator, Func&& func, std::size_t batchSize = 1024);
+    std::size_t parameterizedCaseCount() const;
+
+    // Per-test fixture: func(fixture, args...) gets a fresh F (setUp()/tearDown() called when F has them)
+    // for every run of the assertion (see Fixture/Fixture.h)
+    template <typename F, typename Func, typename... Args>
+    void addFixtureAssertion(Func&& func, Args&&... args);
+
+    // Per-suite fixture: built on first use, shared read-only by every worker, torn down once when the run
+    // that built it ends
+    template <typename F>
+    const F& suiteFixture() { return suiteFixtureSlot<F>().get(); }
+    template <typename F>
+    void setSuiteFixtureFactory(std::function<F()> factory) { suiteFixtureSlot<F>().setFactory(std::move(factory)); }
+
+    // addAssertion with a name and comma separated tags for TestFilter and the rerun state file
+    template <typename Func, typename... Args>
+    void addNamedAssertion(std::string_view name, std::string_view tags, Func&& func, Args&&... args);
+
+    // Statically typed registration: bind each assertion with bindAssertion(func, args...), they are
+    // stored by value in one tuple and run without std::function (see StaticAssertions.h)
+    template <typename... Bound>
+    StaticAssertions<UnitTest<T>, std::decay_t<Bound>...> makeStaticAssertions(Bound&&... bound);
+
+    // Arena-backed registration: the bound closure and its moved-in arguments are bump-allocated in this
+    // suite's arena, next to the previous one. 10^6 registrations cost a few dozen chunk allocations.
+    template <typename Func, typename... Args>
+    void addArenaAssertion(Func&& func, Args&&... args);
+    void reserveArenaAssertions(std::size_t count) { arenaAssertions.reserve(count); }
+    std::size_t arenaAssertionCount() const { return arenaAssertions.size(); }
+
+    // Destroy every arena assertion and free the arena in one go (their registry entries are removed too)
+    void releaseArenaAssertions();
+
+private:
+    template <typename Func, typename... Args>
+    std::function<bool()> makeAssertion(Func&& func, Args&&... args);
+
+    // One slot per (suite, fixture type)
+    template <typename F>
+    static SharedFixture<F>& suiteFixtureSlot() {
+        static SharedFixture<F> slot(FixtureScope::Suite, &getInstance());
+        return slot;
+    }
+
+    // Registry callbacks: run one stored assertion of the suite passed as void*
+    static bool invokeAssertion(void* suite, std::size_t index);
+    static bool invokeSerialAssertion(void* suite, std::size_t index);
+    static bool invokeArenaAssertion(void* suite, std::size_t index);
+    static bool invokeAsyncAssertion(void* suite, std::size_t index);
+    static void invokeAsyncBatch(void* suite, BatchItem* items, std::size_t count);
+    static bool invokeParameterBatch(void* suite, std::size_t index);
+
+    // Cases of one batch counted one by one into summary, true when all of them passed
+    bool runParameterBatch(const ParameterBatch& batch, TestSummary& summary) const;
+
+    struct CaseError {
+        std::size_t caseIndex;
+        const char* what;
+    };
+    static void describeCaseError(std::ostream& os, const void* context);
+
+    // Every async assertion on one loop, numbered from firstIndex in the reports
+    void runAsyncAssertions(TestSummary& summary, std::size_t firstIndex, TimeoutGuard& guard);
+    // The async assertions items[i].index on one loop, labelled by items[i].position
+    void runAsyncBatch(BatchItem* items, std::size_t count, TimeoutGuard& guard);
+
+public:
+
     bool assertEqual(const T& a, const T& b) requires EqualityComparable<T>;
 
     bool assertNotEqual(const T& a, const T& b) requires EqualityUncomparable<T>;
@@ -79,6 +323,39 @@ public:
     template <HasConstIterator Container>
     bool assertNotIn(const T& a, const Container& c, const std::string& functionName = "");
 
+    // Range assertions over contiguous buffers: one block-wise SIMD pass and a single report line
+    // that lists the first maxReported mismatching indices (see Search/RangeCompare.h)
+    bool assertRangeEqual(std::span<const T> actual, std::span<const T> expected, const std::string& functionName = "", std::size_t maxReported = 10) requires EqualityComparable<T>;
+    bool assertAllEqual(std::span<const T> actual, const T& expected, const std::string& functionName = "", std::size_t maxReported = 10) requires EqualityComparable<T>;
+    bool assertAllNear(std::span<const T> actual, std::span<const T> expected, const FloatTolerance& tolerance, const std::string& functionName = "", std::size_t maxReported = 10) requires std::floating_point<T>;
+
+    // property(const T&) must hold for options.cases inputs from generator (see Property/Property.h).
+    // One report line: the case count, or the shrunk counterexample with the seed and case that replay it.
+    template <typename Property, typename Generator = Arbitrary<T>>
+        requires PropertyGenerator<Generator, T>
+    bool assertProperty(Property&& property, const PropertyOptions& options = {}, const Generator& generator = {}, const std::string& functionName = "");
+
+    // body(StressContext&) run concurrently on options.threads threads (see Stress/Stress.h), quiescent() checked
+    // at every round barrier. One report line: the iteration count, or the failure counts, the first failure and the seed.
+    template <typename Body, typename Check = StressNoCheck>
+    bool assertStress(Body&& body, const StressOptions& options = {}, Check&& quiescent = {}, const std::string& functionName = "");
+
+    // Median time per call of wrapper (repeated samples, see Benchmark) must be below limit
+    template <typename... Args>
+    bool assertFasterThan(FunctionWrapper<Args...>& wrapper, std::chrono::nanoseconds limit, const std::string& functionName = "", const BenchmarkOptions& options = {});
+
+    // Fails when wrapper is slower than the baseline stored under name by more than tolerance (0.10 = 10%)
+    // and a Mann-Whitney U test says the slowdown is not noise. A missing baseline is recorded and passes.
+    template <typename... Args>
+    bool assertNoRegression(const std::string& name, FunctionWrapper<Args...>& wrapper, double tolerance = 0.10, const std::string& functionName = "", const BenchmarkOptions& options = {});
+
+    // Allocation assertions, only work when one TU defines CPPTF_TRACK_ALLOCATIONS (see AllocationTracker.h).
+    // func is a FunctionWrapper or any callable; failures list the call sites that allocated.
+    template <typename Func>
+    bool assertNoAllocations(Func&& func, const std::string& functionName = "");
+    template <typename Func>
+    bool assertMaxAllocations(Func&& func, std::size_t maxCount, std::size_t maxBytes = SIZE_MAX, const std::string& functionName = "");
+
     template <typename U>
     bool assertIsInstance(const T& a, const U& b=NULL, const std::string& functionName="");
     template <typename U>
@@ -89,34 +366,383 @@ public:
 template <typename T>
 UnitTest<T>* UnitTest<T>::instance = nullptr;
 template <typename T>
-int UnitTest<T>::instanceCounter = 0;
+std::atomic<std::size_t> UnitTest<T>::instanceCounter{ 0 };
+template <typename T>
+std::atomic<bool> UnitTest<T>::diagnosticsEnabled{ false };
 
 
 template <typename T>
 UnitTest<T>& UnitTest<T>::getInstance() {
     static UnitTest<T> instance;
-    UnitTest<T>::instanceCounter++;
 
-    std::string classType = typeid(T).name();
-    std::cout << "Current instance of the type " << classType << ": instances are " << UnitTest<T>::instanceCounter << std::endl;
+    if (diagnosticsEnabled.load(std::memory_order_relaxed)) {
+        std::size_t count = instanceCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+        std::cout << "Current instance of the type " << typeName() << ": instances are " << count << '\n';
+    }
     return instance;
 }
 
+template <typename T>
+void UnitTest<T>::setDiagnostics(bool enabled) {
+    diagnosticsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::size_t UnitTest<T>::instanceCount() {
+    return instanceCounter.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+const std::string& UnitTest<T>::typeName() {
+    static const std::string name = typeid(T).name();
+    return name;
+}
+
 
 
 // Run all stored assertions
 template <typename T>
-void UnitTest<T>::runTests() {
+TestSummary UnitTest<T>::runTests() {
+    Reporter& reporter = Reporter::current();
+    reporter.beginRun();
+
+    TimeoutGuard guard(timeouts, typeName());
+    TimedRun timedRun;
+    auto run = [&guard](std::size_t index, auto&& assertion) -> bool {
+        AssertionTimer timer(typeName().c_str(), index);
+        return guard.isActive() ? guard.run(index, assertion) : static_cast<bool>(assertion());
+    };
+
+    TestSummary summary;
+    std::size_t index = 0;
     for (const auto& assertion : this->assertions) {
-        assertion();  // Call each stored assertion
+        summary.record(run(index++, assertion));  // Call each stored assertion
+    }
+    for (const auto& assertion : this->arenaAssertions) {
+        summary.record(run(index++, [this, &assertion]() { return assertion.invoke(assertion.closure, *this); }));
     }
+    for (const auto& batch : this->parameterBatches) {
+        TestSummary cases;
+        const bool passed = run(index++, [this, &batch, &cases]() { return runParameterBatch(batch, cases); });
+        summary += cases;
+        if (!passed && cases.failed == 0) {
+            summary.record(false);  // timed out or not run at all
+        }
+    }
+    runAsyncAssertions(summary, index, guard);
+    index += this->asyncAssertions.size();
+    for (const auto& assertion : this->serialAssertions) {
+        summary.record(run(index++, assertion));
+    }
+    guard.reportNotRun();
+    FixtureRegistry::getInstance().teardown(FixtureScope::Suite, this);
+
+    reporter.endRun(summary);
+    timedRun.finish();
+    return summary;
+}
+
+template <typename T>
+TestSummary UnitTest<T>::runTestsParallel(std::size_t workerCount) {
+    ThreadPool pool(workerCount);
+    return runTestsParallel(pool);
+}
+
+template <typename T>
+TestSummary UnitTest<T>::runTestsParallel(ThreadPool& pool) {
+    Reporter& reporter = Reporter::current();
+    reporter.beginRun();
+
+    TimeoutGuard guard(timeouts, typeName());
+    TimedRun timedRun;
+    auto run = [&guard](std::size_t index, auto&& assertion) -> bool {
+        AssertionTimer timer(typeName().c_str(), index);
+        return guard.isActive() ? guard.run(index, assertion) : static_cast<bool>(assertion());
+    };
+
+    // Every worker counts into its own slot, the slots are only summed after the pool is done
+    std::vector<WorkerTally> tallies(pool.size());
+
+    const std::size_t stored = this->assertions.size();
+    const std::size_t arena = stored + this->arenaAssertions.size();
+    pool.parallelFor(arena + this->parameterBatches.size(), [this, stored, arena, &tallies, &run](std::size_t index, std::size_t worker) {
+        if (index < stored) {
+            tallies[worker].summary.record(run(index, this->assertions[index]));
+        }
+        else if (index < arena) {
+            const ArenaAssertion& assertion = this->arenaAssertions[index - stored];
+            tallies[worker].summary.record(run(index, [this, &assertion]() { return assertion.invoke(assertion.closure, *this); }));
+        }
+        else {
+            const ParameterBatch& batch = this->parameterBatches[index - arena];
+            TestSummary cases;
+            const bool passed = run(index, [this, &batch, &cases]() { return runParameterBatch(batch, cases); });
+            tallies[worker].summary += cases;
+            if (!passed && cases.failed == 0) {
+                tallies[worker].summary.record(false);
+            }
+        }
+        });
+
+    TestSummary summary;
+    for (const auto& tally : tallies) {
+        summary += tally.summary;
+    }
+    std::size_t index = arena + this->parameterBatches.size();
+    runAsyncAssertions(summary, index, guard);
+    index += this->asyncAssertions.size();
+    for (const auto& assertion : this->serialAssertions) {
+        summary.record(run(index++, assertion));
+    }
+    guard.reportNotRun();
+    FixtureRegistry::getInstance().teardown(FixtureScope::Suite, this);
+
+    reporter.endRun(summary);
+    timedRun.finish();
+    return summary;
 }
 
 template <typename T>
 template <typename Func, typename... Args>
 void UnitTest<T>::addAssertion(Func&& func, Args&&... args) {
-    this->assertions.push_back([=]() -> bool {
-        if constexpr (std::is_member_function_pointer_v<Func>) {
+    this->assertions.push_back(makeAssertion(std::forward<Func>(func), std::forward<Args>(args)...));
+    TestRegistry::getInstance().add({ &UnitTest<T>::invokeAssertion, this, this->assertions.size() - 1, typeName().c_str(), false });
+}
+
+template <typename T>
+template <typename Func, typename... Args>
+void UnitTest<T>::addSerialAssertion(Func&& func, Args&&... args) {
+    this->serialAssertions.push_back(makeAssertion(std::forward<Func>(func), std::forward<Args>(args)...));
+    TestRegistry::getInstance().add({ &UnitTest<T>::invokeSerialAssertion, this, this->serialAssertions.size() - 1, typeName().c_str(), true, "serial" });
+}
+
+template <typename T>
+template <typename F, typename Func, typename... Args>
+void UnitTest<T>::addFixtureAssertion(Func&& func, Args&&... args) {
+    addAssertion([test = std::forward<Func>(func)](const auto&... bound) -> bool {
+        cpptf_fixture_detail::Scoped<F> scoped;
+        return test(scoped.fixture, bound...);
+        }, std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <CaseGenerator Generator, typename Func>
+void UnitTest<T>::addParameterized(Generator&& generator, Func&& func, std::size_t batchSize) {
+    struct Closure {
+        std::decay_t<Generator> generator;
+        std::decay_t<Func> func;
+    };
+    Closure* closure = parameterArena.template create<Closure>(std::forward<Generator>(generator), std::forward<Func>(func));
+
+    auto runCases = [](void* bound, std::size_t begin, std::size_t end, TestSummary& summary) {
+        Closure& table = *static_cast<Closure*>(bound);
+        bool allPassed = true;
+        for (std::size_t i = begin; i < end; ++i) {
+            bool passed = false;
+            try {
+                passed = static_cast<bool>(cpptf_parameter_detail::invokeCase(table.func, table.generator.at(i)));
+            }
+            catch (const std::exception& error) {
+                Reporter& reporter = Reporter::current();
+                if (reporter.wants(false)) {
+                    CaseError caseError{ i, error.what() };
+                    reporter.report({ false, typeName(), "parameterized", &UnitTest<T>::describeCaseError, &caseError });
+                }
+            }
+            summary.record(passed);
+            allPassed &= passed;
+        }
+        return allPassed;
+    };
+
+    const std::size_t table = this->parameterizedTables.size();
+    this->parameterizedTables.push_back({ runCases, closure });
+
+    const std::size_t cases = closure->generator.size();
+    batchSize = std::max<std::size_t>(batchSize, 1);
+    TestRegistry& registry = TestRegistry::getInstance();
+    for (std::size_t begin = 0; begin < cases; begin += batchSize) {
+        this->parameterBatches.push_back({ table, begin, std::min(begin + batchSize, cases) });
+        registry.add({ &UnitTest<T>::invokeParameterBatch, this, this->parameterBatches.size() - 1, typeName().c_str(), false, "batch" });
+    }
+}
+
+template <typename T>
+std::size_t UnitTest<T>::parameterizedCaseCount() const {
+    std::size_t cases = 0;
+    for (const ParameterBatch& batch : this->parameterBatches) {
+        cases += batch.end - batch.begin;
+    }
+    return cases;
+}
+
+template <typename T>
+bool UnitTest<T>::runParameterBatch(const ParameterBatch& batch, TestSummary& summary) const {
+    const ParameterizedTable& table = this->parameterizedTables[batch.table];
+    return table.runCases(table.closure, batch.begin, batch.end, summary);
+}
+
+template <typename T>
+bool UnitTest<T>::invokeParameterBatch(void* suite, std::size_t index) {
+    UnitTest<T>& owner = *static_cast<UnitTest<T>*>(suite);
+    TestSummary cases;
+    return owner.runParameterBatch(owner.parameterBatches[index], cases);
+}
+
+template <typename T>
+void UnitTest<T>::describeCaseError(std::ostream& os, const void* context) {
+    const CaseError& caseError = *static_cast<const CaseError*>(context);
+    os << "case #" << caseError.caseIndex << " threw: " << caseError.what;
+}
+
+template <typename T>
+template <typename Func, typename... Args>
+void UnitTest<T>::addAsyncAssertion(Func&& func, Args&&... args) {
+    this->asyncAssertions.push_back([func = std::forward<Func>(func), ...args = std::forward<Args>(args)]() mutable -> AsyncAssertion {
+        return func(args...);
+        });
+    TestEntry entry{ &UnitTest<T>::invokeAsyncAssertion, this, this->asyncAssertions.size() - 1, typeName().c_str(), false, "async" };
+    entry.invokeBatch = &UnitTest<T>::invokeAsyncBatch;
+    TestRegistry::getInstance().add(entry);
+}
+
+template <typename T>
+void UnitTest<T>::runAsyncAssertions(TestSummary& summary, std::size_t firstIndex, TimeoutGuard& guard) {
+    if (this->asyncAssertions.empty()) {
+        return;
+    }
+    std::vector<BatchItem> items(this->asyncAssertions.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        items[i].index = i;
+        items[i].position = firstIndex + i;
+    }
+    runAsyncBatch(items.data(), items.size(), guard);
+    for (const BatchItem& item : items) {
+        summary.record(item.passed);
+    }
+}
+
+// The loop times every assertion itself, the guard decides which ones start and with which deadline.
+// A coroutine that blocks the loop thread cannot be timed out by it: the whole run() is one watch, given
+// up on hangLimit after the last deadline.
+template <typename T>
+void UnitTest<T>::runAsyncBatch(BatchItem* items, std::size_t count, TimeoutGuard& guard) {
+    EventLoop loop;
+    loop.stopOnTimeout(guard.isActive() && !timeouts.continueAfterTimeout);
+
+    const std::int64_t start = Watchdog::now();
+    const std::int64_t deadline = guard.isActive() ? guard.deadlineFrom(start) : 0;
+    constexpr EventLoop::TaskId notSpawned = static_cast<EventLoop::TaskId>(-1);
+    std::vector<EventLoop::TaskId> ids(count, notSpawned);
+    for (std::size_t i = 0; i < count; ++i) {
+        items[i].passed = false;
+        if (!guard.isActive() || guard.admit()) {
+            const std::chrono::nanoseconds timeout(deadline != 0 ? deadline - start : 0);
+            ids[i] = loop.spawn(this->asyncAssertions[items[i].index](), typeName(), items[i].position, timeout, items[i].test);
+        }
+    }
+    if (loop.size() == 0) {
+        return;
+    }
+
+    if (deadline != 0) {
+        Watchdog::Watch watch(typeName(), items[0].position, deadline, guard.hangAfter(deadline));
+        loop.run();
+    }
+    else {
+        loop.run();
+    }
+
+    std::size_t cancelled = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (ids[i] == notSpawned) {
+            continue;
+        }
+        const EventLoop::Outcome& outcome = loop.outcome(ids[i]);
+        items[i].passed = outcome.passed;
+        items[i].elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(outcome.elapsed).count();
+        if (outcome.timedOut) {
+            guard.countTimeout(deadline);
+        }
+        cancelled += outcome.cancelled ? 1 : 0;
+    }
+    guard.countNotRun(cancelled);
+}
+
+template <typename T>
+template <typename Func, typename... Args>
+void UnitTest<T>::addNamedAssertion(std::string_view name, std::string_view tags, Func&& func, Args&&... args) {
+    TestRegistry& registry = TestRegistry::getInstance();
+    this->assertions.push_back(makeAssertion(std::forward<Func>(func), std::forward<Args>(args)...));
+
+    TestEntry entry{ &UnitTest<T>::invokeAssertion, this, this->assertions.size() - 1, typeName().c_str(), false };
+    entry.name = registry.intern(name);
+    entry.tags = tags.empty() ? nullptr : registry.intern(tags);
+    registry.add(entry);
+}
+
+template <typename T>
+template <typename... Bound>
+StaticAssertions<UnitTest<T>, std::decay_t<Bound>...> UnitTest<T>::makeStaticAssertions(Bound&&... bound) {
+    return StaticAssertions<UnitTest<T>, std::decay_t<Bound>...>(*this, std::forward<Bound>(bound)...);
+}
+
+template <typename T>
+template <typename Func, typename... Args>
+void UnitTest<T>::addArenaAssertion(Func&& func, Args&&... args) {
+    using Closure = BoundAssertion<std::decay_t<Func>, std::decay_t<Args>...>;
+
+    Closure* closure = assertionArena.template create<Closure>(std::forward<Func>(func), std::forward<Args>(args)...);
+    this->arenaAssertions.push_back({ [](void* bound, UnitTest<T>& suite) { return (*static_cast<Closure*>(bound))(suite); }, closure });
+    TestRegistry::getInstance().add({ &UnitTest<T>::invokeArenaAssertion, this, this->arenaAssertions.size() - 1, typeName().c_str(), false, "arena" });
+}
+
+template <typename T>
+void UnitTest<T>::releaseArenaAssertions() {
+    TestRegistry::getInstance().removeEntries(&UnitTest<T>::invokeArenaAssertion, this);
+    this->arenaAssertions.clear();
+    this->arenaAssertions.shrink_to_fit();
+    this->assertionArena.release();
+}
+
+template <typename T>
+bool UnitTest<T>::invokeArenaAssertion(void* suite, std::size_t index) {
+    UnitTest<T>& owner = *static_cast<UnitTest<T>*>(suite);
+    const ArenaAssertion& assertion = owner.arenaAssertions[index];
+    return assertion.invoke(assertion.closure, owner);
+}
+
+// One entry alone, for runners that call entries one by one (IsolatedRunner)
+template <typename T>
+bool UnitTest<T>::invokeAsyncAssertion(void* suite, std::size_t index) {
+    BatchItem item{ index, index };
+    invokeAsyncBatch(suite, &item, 1);
+    return item.passed;
+}
+
+template <typename T>
+void UnitTest<T>::invokeAsyncBatch(void* suite, BatchItem* items, std::size_t count) {
+    UnitTest<T>& owner = *static_cast<UnitTest<T>*>(suite);
+    TimeoutGuard guard(owner.timeouts, typeName());
+    owner.runAsyncBatch(items, count, guard);
+    guard.reportNotRun();
+}
+
+template <typename T>
+bool UnitTest<T>::invokeAssertion(void* suite, std::size_t index) {
+    return static_cast<UnitTest<T>*>(suite)->assertions[index]();
+}
+
+template <typename T>
+bool UnitTest<T>::invokeSerialAssertion(void* suite, std::size_t index) {
+    return static_cast<UnitTest<T>*>(suite)->serialAssertions[index]();
+}
+
+template <typename T>
+template <typename Func, typename... Args>
+std::function<bool()> UnitTest<T>::makeAssertion(Func&& func, Args&&... args) {
+    return [=, this]() -> bool {
+        if constexpr (std::is_member_function_pointer_v<std::decay_t<Func>>) {
             return (this->*func)((*args)...);
         }
         else {
@@ -124,33 +750,52 @@ void UnitTest<T>::addAssertion(Func&& func, Args&&... args) {
             // (Assuming it takes Args... as parameters.)
             return func(args...);
         }
-        });
+        };
 }
 
 
 template<typename T>
-void UnitTest<T>::printResult(bool passed, const T& testObject, const T& trueObject, const std::string& functionName) {
-    constexpr bool isStreamable = requires(std::ostream & os, const T & obj) { os << obj; };
+void UnitTest<T>::printResult(bool passed, const T& testObject, const T& trueObject, std::string_view functionName, bool shouldBeEqual) {
+    Reporter& reporter = Reporter::current();
+    if (!reporter.wants(passed)) {
+        return;  // e.g. quiet mode and a passing assertion: nothing gets formatted or allocated
+    }
 
-    std::string message = (passed ? "[PASS] " : "[FAIL] ");
-    std::string className = typeid(T).name();  // Get class name dynamically
+    ComparedValues values{ passed, &testObject, &trueObject, &this->diffs, shouldBeEqual };
+    reporter.report({ passed, typeName(), functionName, &UnitTest<T>::describeValues, &values });
+}
 
-    message += "[" + className+ "::" + functionName + "] ";
+template<typename T>
+void UnitTest<T>::describeValues(std::ostream& os, const void* context) {
+    constexpr bool isStreamable = requires(std::ostream & os, const T & obj) { os << obj; };
+    const ComparedValues& values = *static_cast<const ComparedValues*>(context);
 
+    if constexpr (isDiffable<T>) {
+        if (!values.passed && values.shouldBeEqual) {
+            writeDiff(os, *values.testObject, *values.trueObject, *values.diff);
+            return;
+        }
+    }
     if constexpr (isStreamable) {
-        std::cout << message << testObject << " "
-            << (passed ? "==" : "!=")
-            << " " << trueObject << std::endl;
+        // Bounded: a huge value costs maxValueChars of output, not its full size
+        cpptf_diff_detail::writeBounded(os, *values.testObject, values.diff->maxValueChars);
+        os << " " << (values.passed ? "==" : "!=") << " ";
+        cpptf_diff_detail::writeBounded(os, *values.trueObject, values.diff->maxValueChars);
     }
     else {
-        std::cout << message << (passed ? "Objects are equal." : "Objects are not equal.") << std::endl;
+        os << (values.passed ? "Objects are equal." : "Objects are not equal.");
     }
 }
 
+template<typename T>
+void UnitTest<T>::describeBoolean(std::ostream& os, const void* context) {
+    os << (*static_cast<const bool*>(context) ? "Value is true." : "Value is false.");
+}
+
 template<typename T>
 bool UnitTest<T>::assertEqual(const T& testObject, const T& trueObject) requires EqualityComparable<T> {
     bool result = (testObject == trueObject);
-    printResult(result, testObject, trueObject, "assertEqual");
+    printResult(result, testObject, trueObject, "assertEqual", true);
     return result;
 }
 
@@ -162,17 +807,52 @@ bool UnitTest<T>::assertNotEqual(const T& testObject, const T& trueObject) requi
 }
 
 
+template <typename T>
+template <typename Property, typename Generator>
+    requires PropertyGenerator<Generator, T>
+bool UnitTest<T>::assertProperty(Property&& property, const PropertyOptions& options, const Generator& generator, const std::string& functionName) {
+    PropertyResult<T> outcome = checkProperty<T>(property, options, generator);
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(outcome.passed)) {
+        reporter.report({ outcome.passed, typeName(), nameOr(functionName, "assertProperty"), [](std::ostream& os, const void* context) {
+            describePropertyResult(os, *static_cast<const PropertyResult<T>*>(context));
+            }, &outcome });
+    }
+    return outcome.passed;
+}
+
+template <typename T>
+template <typename Body, typename Check>
+bool UnitTest<T>::assertStress(Body&& body, const StressOptions& options, Check&& quiescent, const std::string& functionName) {
+    const StressResult outcome = runStress(body, options, quiescent);
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(outcome.passed)) {
+        reporter.report({ outcome.passed, typeName(), nameOr(functionName, "assertStress"), [](std::ostream& os, const void* context) {
+            describeStressResult(os, *static_cast<const StressResult*>(context));
+            }, &outcome });
+    }
+    return outcome.passed;
+}
+
 template <typename T>
 bool UnitTest<T>::assertTrue(const T& testObject) requires BooleanConvertible<T> {
-    bool result = static_cast<bool>(testObject);
-    std::cout << (result ? "[PASS] Value is true." : "[FAIL] Value is false.") << std::endl;
+    bool value = static_cast<bool>(testObject);
+    bool result = value;
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(result)) {
+        reporter.report({ result, typeName(), "assertTrue", &UnitTest<T>::describeBoolean, &value });
+    }
     return result;
 }
 
 template <typename T>
 bool UnitTest<T>::assertFalse(const T& testObject) requires BooleanConvertible<T> {
-    bool result = not static_cast<bool>(testObject);
-    std::cout << (result ? "[PASS] Value is false." : "[FAIL] Value is true.") << std::endl;
+    bool value = static_cast<bool>(testObject);
+    bool result = not value;
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(result)) {
+        reporter.report({ result, typeName(), "assertFalse", &UnitTest<T>::describeBoolean, &value });
+    }
     return result;
 }
 
@@ -195,56 +875,70 @@ bool UnitTest<T>::assertIsNot(const T& testObject, const T& trueObject, const st
 template <typename T>
 bool UnitTest<T>::assertIsNULL(const T& testObject, const std::string& functionName) {
     bool result = (testObject == NULL);
-    printResult(result, testObject, NULL, functionName.empty() ? "assertIsNULL" : functionName);
+    printResult(result, testObject, NULL, nameOr(functionName, "assertIsNULL"));
     return result;
 }
 
 template <typename T>
 bool UnitTest<T>::assertIsNotNULL(const T& testObject, const std::string& functionName) {
     bool result = not (testObject == NULL);
-    printResult(result, testObject, NULL, functionName.empty() ? "assertIsNotNULL" : functionName);
+    printResult(result, testObject, NULL, nameOr(functionName, "assertIsNotNULL"));
     return result;
 }
 
 template <typename T>
 bool UnitTest<T>::assertIsNullptr(const T* testObject, const std::string& functionName) {
     bool result = (testObject == nullptr);
-    printResult(result, T{}, T{}, functionName.empty() ? "assertIsNullptr" : functionName);
+    printResult(result, T{}, T{}, nameOr(functionName, "assertIsNullptr"));
     return result;
 }
 
 template <typename T>
 bool UnitTest<T>::assertIsNotNullptr(const T* testObject, const std::string& functionName) {
     bool result = not (testObject == nullptr);
-    printResult(result, T{}, T{}, functionName.empty() ? "assertIsNotNullptr" : functionName);
+    printResult(result, T{}, T{}, nameOr(functionName, "assertIsNotNullptr"));
     return result;
 }
 
+// `assertIn` / `assertNotIn`: lookup strategy depends on the container, see Search/ContainerSearch.h
+// (substring search for strings, find()/contains() for sets and maps, SIMD scan for arithmetic arrays)
 template <typename T>
 template <HasConstIterator Container>
 bool UnitTest<T>::assertIn(const T& testObject, const Container& c, const std::string& functionName) {
-    for (const auto& item : c) {
-        if (item == testObject) {
-            printResult(true, T{}, T{}, functionName.empty() ? "assertIn" : functionName);
-            return true;
-        }
-    }
-    printResult(false, T{}, T{}, functionName.empty() ? "assertIn" : functionName);
-    return false;
+    bool found = containerContains(c, testObject);
+    reportMembership(found, testObject, found, nameOr(functionName, "assertIn"));
+    return found;
 }
 
 
 template <typename T>
 template <HasConstIterator Container>
 bool UnitTest<T>::assertNotIn(const T& testObject, const Container& c, const std::string& functionName) {
-    for (const auto& item : c) {
-        if (item == testObject) {
-            printResult(false, T{}, T{}, functionName.empty() ? "assertIn" : functionName);
-            return false;
-        }
+    bool found = containerContains(c, testObject);
+    reportMembership(not found, testObject, found, nameOr(functionName, "assertNotIn"));
+    return not found;
+}
+
+template <typename T>
+void UnitTest<T>::reportMembership(bool passed, const T& testObject, bool found, std::string_view functionName) {
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(passed)) {
+        Membership membership{ &testObject, found };
+        reporter.report({ passed, typeName(), functionName, &UnitTest<T>::describeMembership, &membership });
+    }
+}
+
+template <typename T>
+void UnitTest<T>::describeMembership(std::ostream& os, const void* context) {
+    constexpr bool isStreamable = requires(std::ostream & os, const T & obj) { os << obj; };
+    const Membership& membership = *static_cast<const Membership*>(context);
+
+    if constexpr (isStreamable) {
+        os << *membership.value << (membership.found ? " is in the container" : " is not in the container");
+    }
+    else {
+        os << (membership.found ? "Object is in the container." : "Object is not in the container.");
     }
-    printResult(true, T{}, T{}, functionName.empty() ? "assertIn" : functionName);
-    return true;
 }
 
 
@@ -252,7 +946,7 @@ template <typename T>
 template <typename U>
 bool UnitTest<T>::assertIsInstance(const T& testObject, const U& b, const std::string& functionName) {
     bool result = std::is_base_of<T, U>::value;
-    printResult(result, testObject, testObject, functionName.empty() ? "assertIsInstance" : functionName);
+    printResult(result, testObject, testObject, nameOr(functionName, "assertIsInstance"));
     return result;
 }
 
@@ -260,6 +954,193 @@ template <typename T>
 template <typename U>
 bool UnitTest<T>::assertIsNotInstance(const T& testObject, const U& b, const std::string& functionName) {
     bool result = not std::is_base_of<T, U>::value;
-    printResult(result, testObject, testObject, functionName.empty() ? "assertIsNotInstance" : functionName);
+    printResult(result, testObject, testObject, nameOr(functionName, "assertIsNotInstance"));
+    return result;
+}
+
+template <typename T>
+template <typename... Args>
+bool UnitTest<T>::assertFasterThan(FunctionWrapper<Args...>& wrapper, std::chrono::nanoseconds limit, const std::string& functionName, const BenchmarkOptions& options) {
+    BenchmarkResult measured = Benchmark(options).run(std::string(nameOr(functionName, "assertFasterThan")), wrapper);
+    const double limitNs = std::chrono::duration<double, std::nano>(limit).count();
+
+    bool result = measured.nanoseconds.median < limitNs;
+    reportTiming(result, nameOr(functionName, "assertFasterThan"), { measured.nanoseconds.median, limitNs, -1.0, false });
     return result;
-}
\ No newline at end of file
+}
+
+template <typename T>
+template <typename... Args>
+bool UnitTest<T>::assertNoRegression(const std::string& name, FunctionWrapper<Args...>& wrapper, double tolerance, const std::string& functionName, const BenchmarkOptions& options) {
+    BaselineStore& store = BaselineStore::getInstance();
+    BenchmarkResult measured = Benchmark(options).run(name, wrapper);
+    std::optional<std::vector<double>> baseline = store.find(name);
+
+    if (!baseline || baseline->empty()) {
+        store.store(name, measured.samples);
+        reportTiming(true, nameOr(functionName, "assertNoRegression"), { measured.nanoseconds.median, 0.0, -1.0, true });
+        return true;
+    }
+
+    std::vector<double> baselineSamples = *baseline;
+    const double baselineMedian = SampleStats::compute(baselineSamples).median;
+    const double pValue = slowerThanBaselinePValue(measured.samples, baselineSamples);
+
+    bool slower = measured.nanoseconds.median > baselineMedian * (1.0 + tolerance);
+    bool result = not (slower && pValue < regressionSignificance);
+
+    if (store.updatesBaselines()) {
+        store.store(name, measured.samples);
+    }
+    reportTiming(result, nameOr(functionName, "assertNoRegression"), { measured.nanoseconds.median, baselineMedian, pValue, true });
+    return result;
+}
+
+template <typename T>
+void UnitTest<T>::reportTiming(bool passed, std::string_view functionName, const TimingComparison& timing) {
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(passed)) {
+        reporter.report({ passed, typeName(), functionName, &UnitTest<T>::describeTiming, &timing });
+    }
+}
+
+template <typename T>
+void UnitTest<T>::describeTiming(std::ostream& os, const void* context) {
+    const TimingComparison& timing = *static_cast<const TimingComparison*>(context);
+
+    os << "median " << timing.medianNs << " ns";
+    if (!timing.againstBaseline) {
+        os << " vs limit " << timing.referenceNs << " ns";
+    }
+    else if (timing.pValue < 0) {
+        os << ", no baseline yet, recorded";
+    }
+    else {
+        const double change = (timing.medianNs / timing.referenceNs - 1.0) * 100.0;
+        os << " vs baseline " << timing.referenceNs << " ns (" << (change >= 0 ? "+" : "") << change << "%, p=" << timing.pValue << ")";
+    }
+}
+
+template <typename T>
+template <typename Func>
+void UnitTest<T>::invokeCallable(Func& func) {
+    if constexpr (requires { func.call(); }) {
+        func.call();
+    }
+    else {
+        func();
+    }
+}
+
+template <typename T>
+template <typename Func>
+bool UnitTest<T>::assertNoAllocations(Func&& func, const std::string& functionName) {
+    return assertMaxAllocations(std::forward<Func>(func), 0, 0, std::string(nameOr(functionName, "assertNoAllocations")));
+}
+
+template <typename T>
+template <typename Func>
+bool UnitTest<T>::assertMaxAllocations(Func&& func, std::size_t maxCount, std::size_t maxBytes, const std::string& functionName) {
+    Reporter& reporter = Reporter::current();
+    const std::string_view name = nameOr(functionName, "assertMaxAllocations");
+
+    if (!AllocationTracker::enabled()) {
+        if (reporter.wants(false)) {
+            reporter.report({ false, typeName(), name, [](std::ostream& os, const void*) {
+                os << "allocation tracking is off, define CPPTF_TRACK_ALLOCATIONS in one translation unit";
+                }, nullptr });
+        }
+        return false;
+    }
+
+    AllocationCounters counted;
+    {
+        AllocationScope scope;
+        invokeCallable(func);
+        counted = scope.counters();
+    }
+
+    bool result = counted.allocations <= maxCount && counted.bytes <= maxBytes;
+    if (reporter.wants(result)) {
+        AllocationCheck check{ &counted, maxCount, maxBytes };
+        reporter.report({ result, typeName(), name, &UnitTest<T>::describeAllocations, &check });
+    }
+    return result;
+}
+
+template <typename T>
+void UnitTest<T>::describeAllocations(std::ostream& os, const void* context) {
+    const AllocationCheck& check = *static_cast<const AllocationCheck*>(context);
+
+    writeAllocationBreakdown(os, *check.counted);
+    os << " (limit " << check.maxCount << " allocations";
+    if (check.maxBytes != SIZE_MAX) {
+        os << ", " << check.maxBytes << " bytes";
+    }
+    os << ")";
+}
+
+template <typename T>
+bool UnitTest<T>::assertRangeEqual(std::span<const T> actual, std::span<const T> expected, const std::string& functionName, std::size_t maxReported) requires EqualityComparable<T> {
+    RangeComparison comparison = compareRanges(actual, expected, maxReported);
+    bool result = comparison.passed() && actual.size() == expected.size();
+    reportRange(result, nameOr(functionName, "assertRangeEqual"), { &comparison, actual, expected, nullptr });
+    return result;
+}
+
+template <typename T>
+bool UnitTest<T>::assertAllEqual(std::span<const T> actual, const T& expected, const std::string& functionName, std::size_t maxReported) requires EqualityComparable<T> {
+    RangeComparison comparison = compareRangeToValue(actual, expected, maxReported);
+    bool result = comparison.passed();
+    reportRange(result, nameOr(functionName, "assertAllEqual"), { &comparison, actual, {}, &expected });
+    return result;
+}
+
+template <typename T>
+bool UnitTest<T>::assertAllNear(std::span<const T> actual, std::span<const T> expected, const FloatTolerance& tolerance, const std::string& functionName, std::size_t maxReported) requires std::floating_point<T> {
+    RangeComparison comparison = compareRangesNear(actual, expected, tolerance, maxReported);
+    bool result = comparison.passed() && actual.size() == expected.size();
+    reportRange(result, nameOr(functionName, "assertAllNear"), { &comparison, actual, expected, nullptr });
+    return result;
+}
+
+template <typename T>
+void UnitTest<T>::reportRange(bool passed, std::string_view functionName, const RangeReport& report) {
+    Reporter& reporter = Reporter::current();
+    if (reporter.wants(passed)) {
+        reporter.report({ passed, typeName(), functionName, &UnitTest<T>::describeRange, &report });
+    }
+}
+
+template <typename T>
+void UnitTest<T>::describeRange(std::ostream& os, const void* context) {
+    constexpr bool isStreamable = requires(std::ostream & os, const T & obj) { os << obj; };
+    const RangeReport& report = *static_cast<const RangeReport*>(context);
+    const RangeComparison& comparison = *report.comparison;
+
+    if (report.expectedValue == nullptr && report.actual.size() != report.expected.size()) {
+        os << "sizes differ (" << report.actual.size() << " vs " << report.expected.size() << "), ";
+    }
+    if (comparison.mismatches == 0) {
+        os << "all " << comparison.compared << " compared elements match";
+        return;
+    }
+
+    os << comparison.mismatches << " of " << comparison.compared << " elements differ";
+    const std::streamsize savedPrecision = os.precision();
+    if constexpr (std::is_floating_point_v<T>) {
+        os.precision(std::numeric_limits<T>::max_digits10);  // "1 != 1" helps nobody
+    }
+    for (std::size_t i = 0; i < comparison.firstMismatches.size(); ++i) {
+        const std::size_t index = comparison.firstMismatches[i];
+        os << (i == 0 ? ": " : ", ") << "[" << index << "]";
+        if constexpr (isStreamable) {
+            const T& expected = report.expectedValue != nullptr ? *report.expectedValue : report.expected[index];
+            os << " " << report.actual[index] << " != " << expected;
+        }
+    }
+    os.precision(savedPrecision);
+    if (comparison.mismatches > comparison.firstMismatches.size()) {
+        os << ", ...";
+    }
+}
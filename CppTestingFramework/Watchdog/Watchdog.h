@@ -0,0 +1,549 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cstdlib>
+#include<cstdio>
+#include<new>
+#include<chrono>
+#include<deque>
+#include<vector>
+#include<mutex>
+#include<condition_variable>
+#include<thread>
+#include<atomic>
+#include<iostream>
+#include<string_view>
+#include<algorithm>
+#include<initializer_list>
+#include "../Reporter/Reporter.h"
+
+#if __has_include(<pthread.h>) && __has_include(<unistd.h>)
+#include<pthread.h>
+#include<unistd.h>
+#define CPPTF_WATCHDOG_HAS_ATFORK 1
+#endif
+
+// Time limits for UnitTest<T>::runTests / runTestsParallel.
+//
+// Each running assertion arms a watch: two relaxed stores into a slot owned by its thread, no lock and no
+// syscall. One watchdog thread scans the slots every few milliseconds while a guarded run is in progress and
+// flags the ones past their deadline. An assertion that comes back late is reported as a timeout failure with
+// its elapsed time. One that never comes back cannot be stopped from inside the process: once it is hangLimit
+// past its deadline the watchdog reports it and ends the process with exit code 124 (like timeout(1)),
+// which IsolatedRunner then turns into a per-test failure. Unless set, hangLimit follows the timeouts, so a
+// run with any limit at all always ends.
+//
+// A watch can also name a flag the watchdog raises when its deadline passes; TimeoutGuard uses it to stop the
+// other threads of a run without waiting for the late assertion to come back.
+// In a fork()ed child the watchdog starts over: no scanner thread, and only the forking thread's slot kept.
+
+struct TimeoutOptions {
+    std::chrono::milliseconds assertionTimeout{ 0 };  // per assertion, 0 = no limit
+    std::chrono::milliseconds suiteTimeout{ 0 };      // whole run of one suite, 0 = no limit
+    bool continueAfterTimeout = true;                 // false: the first timed out assertion ends the run
+    std::chrono::milliseconds hangLimit{ 0 };         // give up on the process this long past a deadline,
+                                                      // 0 = automatic (see effectiveHangLimit), negative = never
+
+    bool enabled() const { return assertionTimeout.count() > 0 || suiteTimeout.count() > 0; }
+
+    // hangLimit, or for 0: 10 times the tightest timeout set, at least 10 s. 0 when there is none.
+    std::chrono::milliseconds effectiveHangLimit() const {
+        if (hangLimit.count() != 0 || !enabled()) {
+            return hangLimit;
+        }
+        std::chrono::milliseconds tightest = assertionTimeout.count() > 0 ? assertionTimeout : suiteTimeout;
+        if (suiteTimeout.count() > 0) {
+            tightest = std::min(tightest, suiteTimeout);
+        }
+        return std::max(tightest * 10, std::chrono::milliseconds(std::chrono::seconds(10)));
+    }
+};
+
+class Watchdog {
+private:
+    struct Slot;
+
+public:
+    static constexpr int hangExitCode = 124;
+    static constexpr std::chrono::milliseconds tick{ 10 };
+
+    static Watchdog& getInstance();
+
+    // Monotonic nanoseconds, never 0
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() + 1;
+    }
+
+    // Armed for the lifetime of one assertion on the calling thread
+    class Watch {
+    private:
+        Slot* slot;
+        std::int64_t start;
+
+    public:
+        // deadline / hang are Watchdog::now() based, 0 = none. onExpiry (optional) is set along with expired(),
+        // it must outlive the enclosing beginWatching / endWatching pair.
+        Watch(std::string_view suiteName, std::size_t index, std::int64_t deadline, std::int64_t hang,
+            std::atomic<bool>* onExpiry = nullptr);
+        ~Watch();
+
+        Watch(const Watch&) = delete;
+        Watch& operator=(const Watch&) = delete;
+
+        // Without the time spent in Pause
+        std::chrono::nanoseconds elapsed() const { return std::chrono::nanoseconds(now() - start - slot->pausedNs); }
+        // Set by the watchdog once the deadline has passed
+        bool expired() const;
+    };
+
+    // Stops the clock of the calling thread's watch, if it has one, for its lifetime: the deadline and hang
+    // limit move out by the paused time and the scanner skips the watch meanwhile. Nested pauses count once.
+    class Pause {
+    private:
+        Slot* slot = nullptr;
+        std::int64_t start = 0;
+
+    public:
+        Pause();
+        ~Pause();
+
+        Pause(const Pause&) = delete;
+        Pause& operator=(const Pause&) = delete;
+    };
+
+    // A guarded run is in progress: keep scanning
+    void beginWatching();
+    void endWatching();
+    // Some guarded run is in progress on some thread
+    bool isWatching();
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::int64_t> start{ 0 };     // 0 while idle
+        std::atomic<std::int64_t> deadline{ 0 };
+        std::atomic<std::int64_t> hang{ 0 };
+        std::atomic<bool> expired{ false };
+        std::atomic<std::int64_t> paused{ 0 };    // start of the current Pause, 0 while running
+        std::int64_t pausedNs = 0;                // owner thread only
+        std::atomic<bool>* onExpiry = nullptr;    // written before start is published
+        std::string_view suiteName;
+        std::size_t index = 0;
+    };
+
+    // What giveUp needs, copied out of the slot under the lock
+    struct Hang {
+        std::string_view suiteName;
+        std::size_t index;
+        double runningMs;
+    };
+
+    // Returns the calling thread's slot to the free list when the thread exits
+    struct SlotHandle {
+        Slot* slot = nullptr;
+        ~SlotHandle() {
+            if (slot != nullptr) {
+                Watchdog::getInstance().releaseSlot(slot);
+            }
+        }
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Slot> slots;          // deque: slots never move
+    std::vector<Slot*> freeSlots;
+    std::size_t watching = 0;
+    bool stopping = false;
+    std::thread thread;
+
+    Watchdog();
+    ~Watchdog();
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    static SlotHandle& localHandle();
+    static Slot& localSlot();
+    Slot* acquireSlot();
+    void releaseSlot(Slot* slot);
+
+    void loop();
+    [[noreturn]] static void giveUp(const Hang& hang);
+
+#ifdef CPPTF_WATCHDOG_HAS_ATFORK
+    static void beforeFork();
+    static void afterForkParent();
+    static void afterForkChild();
+#endif
+
+    friend class Watch;
+};
+
+// Applies one TimeoutOptions to one run of a suite; shared by all threads of runTestsParallel
+class TimeoutGuard {
+private:
+    const TimeoutOptions& options;
+    std::string_view suiteName;
+    bool active;
+    std::int64_t suiteDeadline = 0;
+    std::atomic<bool> stopped{ false };
+    std::atomic<bool> stoppedBySuite{ false };
+    std::atomic<std::size_t> notRun{ 0 };
+    std::atomic<std::size_t> timedOutCount{ 0 };
+
+    struct TimedOut {
+        std::size_t index;
+        double elapsedMs;
+        bool suiteLimit;
+        double limitMs;
+    };
+    struct NotRun {
+        std::size_t count;
+        bool suiteLimit;
+        double limitMs;
+    };
+    static void describeTimedOut(std::ostream& os, const void* context);
+    static void describeNotRun(std::ostream& os, const void* context);
+
+public:
+    TimeoutGuard(const TimeoutOptions& options, std::string_view suiteName);
+    ~TimeoutGuard();
+
+    TimeoutGuard(const TimeoutGuard&) = delete;
+    TimeoutGuard& operator=(const TimeoutGuard&) = delete;
+
+    bool isActive() const { return active; }
+
+    // Run one assertion under the limits. Returns false without running it once the run has been stopped.
+    template <typename Assertion>
+    bool run(std::size_t index, Assertion&& assertion);
+
+    // The pieces of run() for assertions that are timed by someone else (the EventLoop of async assertions).
+    // admit: false, and counted as not run, once the run has been stopped or the suite time is up.
+    bool admit();
+    // Deadline of an assertion starting at start, and the point to give up on the process; Watchdog::now() based
+    std::int64_t deadlineFrom(std::int64_t start) const;
+    std::int64_t hangAfter(std::int64_t deadline) const;
+    // An assertion with this deadline timed out (already reported) / count assertions dropped unrun
+    void countTimeout(std::int64_t deadline);
+    void countNotRun(std::size_t count) { notRun.fetch_add(count, std::memory_order_relaxed); }
+
+    // One failure line for everything that was skipped, call once the run is over
+    void reportNotRun();
+
+    std::size_t timedOut() const { return timedOutCount.load(std::memory_order_relaxed); }
+};
+
+
+inline Watchdog& Watchdog::getInstance() {
+    static Watchdog watchdog;
+    return watchdog;
+}
+
+inline Watchdog::Watchdog() {
+#ifdef CPPTF_WATCHDOG_HAS_ATFORK
+    // Once per process: getInstance() constructs the one instance
+    ::pthread_atfork(&Watchdog::beforeFork, &Watchdog::afterForkParent, &Watchdog::afterForkChild);
+#endif
+}
+
+inline Watchdog::~Watchdog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+inline Watchdog::SlotHandle& Watchdog::localHandle() {
+    thread_local SlotHandle handle;
+    return handle;
+}
+
+inline Watchdog::Slot& Watchdog::localSlot() {
+    SlotHandle& handle = localHandle();
+    if (handle.slot == nullptr) {
+        handle.slot = getInstance().acquireSlot();
+    }
+    return *handle.slot;
+}
+
+inline Watchdog::Slot* Watchdog::acquireSlot() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!freeSlots.empty()) {
+        Slot* slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    return &slots.emplace_back();
+}
+
+inline void Watchdog::releaseSlot(Slot* slot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    slot->start.store(0, std::memory_order_relaxed);
+    freeSlots.push_back(slot);
+}
+
+inline void Watchdog::beginWatching() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++watching;
+        if (!thread.joinable()) {
+            thread = std::thread([this]() { loop(); });
+        }
+    }
+    wake.notify_one();
+}
+
+inline void Watchdog::endWatching() {
+    std::lock_guard<std::mutex> lock(mutex);
+    --watching;
+}
+
+inline bool Watchdog::isWatching() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return watching > 0;
+}
+
+inline void Watchdog::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (watching == 0) {
+            wake.wait(lock, [this]() { return stopping || watching > 0; });
+            continue;
+        }
+
+        const std::int64_t nowNs = now();
+        for (Slot& slot : slots) {
+            const std::int64_t start = slot.start.load(std::memory_order_acquire);
+            if (start == 0 || slot.paused.load(std::memory_order_acquire) != 0) {
+                continue;
+            }
+            // onExpiry stays valid while the lock is held: its guard's endWatching has to take it first
+            const std::int64_t deadline = slot.deadline.load(std::memory_order_relaxed);
+            if (deadline != 0 && nowNs >= deadline && !slot.expired.exchange(true, std::memory_order_relaxed)
+                && slot.onExpiry != nullptr) {
+                slot.onExpiry->store(true, std::memory_order_relaxed);
+            }
+            const std::int64_t hang = slot.hang.load(std::memory_order_relaxed);
+            if (hang != 0 && nowNs >= hang) {
+                const Hang stuck{ slot.suiteName, slot.index, static_cast<double>(nowNs - start) / 1e6 };
+                lock.unlock();
+                giveUp(stuck);
+            }
+        }
+        wake.wait_for(lock, tick);
+    }
+}
+
+// The other threads keep running until _Exit, so no reporter and no iostream here: one line, formatted on
+// the stack and handed to write(2)
+inline void Watchdog::giveUp(const Hang& hang) {
+    char line[512];
+    int length = std::snprintf(line, sizeof(line), "[FAIL] [%.*s::timeout] assertion #%zu still running after %.1f ms, ending the process\n",
+        static_cast<int>(std::min<std::size_t>(hang.suiteName.size(), 256)), hang.suiteName.data(), hang.index, hang.runningMs);
+    length = std::clamp(length, 0, static_cast<int>(sizeof(line)) - 1);
+#ifdef CPPTF_WATCHDOG_HAS_ATFORK
+    for (const char* next = line; length > 0;) {
+        const ssize_t written = ::write(STDERR_FILENO, next, static_cast<std::size_t>(length));
+        if (written <= 0) {
+            break;
+        }
+        next += written;
+        length -= static_cast<int>(written);
+    }
+#else
+    std::fwrite(line, 1, static_cast<std::size_t>(length), stderr);
+#endif
+    std::_Exit(hangExitCode);
+}
+
+#ifdef CPPTF_WATCHDOG_HAS_ATFORK
+// The scanner cannot hold the lock across fork(), so the child gets the slots in a consistent state
+inline void Watchdog::beforeFork() {
+    getInstance().mutex.lock();
+}
+
+inline void Watchdog::afterForkParent() {
+    getInstance().mutex.unlock();
+}
+
+// Only the forking thread exists in the child: drop the scanner (it is started again by the next
+// beginWatching) and the other threads' watches, which would otherwise look hung forever
+inline void Watchdog::afterForkChild() {
+    Watchdog& watchdog = getInstance();
+    new (&watchdog.mutex) std::mutex();
+    new (&watchdog.wake) std::condition_variable();
+    new (&watchdog.thread) std::thread();
+    const Slot* own = localHandle().slot;
+    for (Slot& slot : watchdog.slots) {
+        if (&slot != own) {
+            slot.start.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+#endif
+
+inline Watchdog::Watch::Watch(std::string_view suiteName, std::size_t index, std::int64_t deadline, std::int64_t hang,
+    std::atomic<bool>* onExpiry)
+    : slot(&Watchdog::localSlot()), start(now()) {
+    slot->onExpiry = onExpiry;
+    slot->pausedNs = 0;
+    slot->paused.store(0, std::memory_order_relaxed);
+    slot->suiteName = suiteName;
+    slot->index = index;
+    slot->deadline.store(deadline, std::memory_order_relaxed);
+    slot->hang.store(hang, std::memory_order_relaxed);
+    slot->expired.store(false, std::memory_order_relaxed);
+    slot->start.store(start, std::memory_order_release);
+}
+
+inline Watchdog::Watch::~Watch() {
+    slot->start.store(0, std::memory_order_relaxed);
+}
+
+inline bool Watchdog::Watch::expired() const {
+    return slot->expired.load(std::memory_order_relaxed);
+}
+
+inline Watchdog::Pause::Pause() {
+    Slot* own = localHandle().slot;
+    if (own != nullptr && own->start.load(std::memory_order_relaxed) != 0 && own->paused.load(std::memory_order_relaxed) == 0) {
+        slot = own;
+        start = now();
+        slot->paused.store(start, std::memory_order_release);
+    }
+}
+
+inline Watchdog::Pause::~Pause() {
+    if (slot == nullptr) {
+        return;
+    }
+    const std::int64_t length = now() - start;
+    for (std::atomic<std::int64_t>* limit : { &slot->deadline, &slot->hang }) {
+        const std::int64_t value = limit->load(std::memory_order_relaxed);
+        if (value != 0) {
+            limit->store(value + length, std::memory_order_relaxed);
+        }
+    }
+    slot->pausedNs += length;
+    slot->paused.store(0, std::memory_order_release);
+}
+
+
+inline TimeoutGuard::TimeoutGuard(const TimeoutOptions& options, std::string_view suiteName)
+    : options(options), suiteName(suiteName), active(options.enabled()) {
+    if (active) {
+        if (options.suiteTimeout.count() > 0) {
+            suiteDeadline = Watchdog::now() + std::chrono::duration_cast<std::chrono::nanoseconds>(options.suiteTimeout).count();
+        }
+        Watchdog::getInstance().beginWatching();
+    }
+}
+
+inline TimeoutGuard::~TimeoutGuard() {
+    if (active) {
+        Watchdog::getInstance().endWatching();
+    }
+}
+
+inline bool TimeoutGuard::admit() {
+    if (stopped.load(std::memory_order_relaxed)) {
+        notRun.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (suiteDeadline != 0 && Watchdog::now() >= suiteDeadline) {
+        stoppedBySuite.store(true, std::memory_order_relaxed);
+        stopped.store(true, std::memory_order_relaxed);
+        notRun.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+inline std::int64_t TimeoutGuard::deadlineFrom(std::int64_t start) const {
+    std::int64_t deadline = suiteDeadline;
+    if (options.assertionTimeout.count() > 0) {
+        const std::int64_t own = start + std::chrono::duration_cast<std::chrono::nanoseconds>(options.assertionTimeout).count();
+        deadline = deadline == 0 ? own : std::min(deadline, own);
+    }
+    return deadline;
+}
+
+inline std::int64_t TimeoutGuard::hangAfter(std::int64_t deadline) const {
+    const std::chrono::milliseconds limit = options.effectiveHangLimit();
+    return limit.count() > 0 && deadline != 0
+        ? deadline + std::chrono::duration_cast<std::chrono::nanoseconds>(limit).count() : 0;
+}
+
+inline void TimeoutGuard::countTimeout(std::int64_t deadline) {
+    timedOutCount.fetch_add(1, std::memory_order_relaxed);
+    if (suiteDeadline != 0 && deadline == suiteDeadline) {
+        stoppedBySuite.store(true, std::memory_order_relaxed);
+        stopped.store(true, std::memory_order_relaxed);
+    }
+    if (!options.continueAfterTimeout) {
+        stopped.store(true, std::memory_order_relaxed);
+    }
+}
+
+template <typename Assertion>
+bool TimeoutGuard::run(std::size_t index, Assertion&& assertion) {
+    if (!admit()) {
+        return false;
+    }
+
+    const std::int64_t deadline = deadlineFrom(Watchdog::now());
+    // When this deadline ends the run anyway, the watchdog stops the other threads as soon as it passes
+    const bool suiteBound = suiteDeadline != 0 && deadline == suiteDeadline;
+    Watchdog::Watch watch(suiteName, index, deadline, hangAfter(deadline), suiteBound || !options.continueAfterTimeout ? &stopped : nullptr);
+    const bool passed = static_cast<bool>(assertion());
+    const std::chrono::nanoseconds elapsed = watch.elapsed();
+
+    // The watchdog flag is coarse (one tick): the measured time decides for the assertion limit,
+    // the flag catches the suite deadline passing while the assertion ran
+    const bool overOwn = options.assertionTimeout.count() > 0 && elapsed > options.assertionTimeout;
+    const bool overSuite = !overOwn && watch.expired();
+    if (overOwn || overSuite) {
+        timedOutCount.fetch_add(1, std::memory_order_relaxed);
+        if (overSuite) {
+            stoppedBySuite.store(true, std::memory_order_relaxed);
+        }
+        if (overSuite || !options.continueAfterTimeout) {
+            stopped.store(true, std::memory_order_relaxed);
+        }
+
+        Reporter& reporter = Reporter::current();
+        if (reporter.wants(false)) {
+            TimedOut timedOut{ index, static_cast<double>(elapsed.count()) / 1e6, overSuite,
+                static_cast<double>(overSuite ? options.suiteTimeout.count() : options.assertionTimeout.count()) };
+            reporter.report({ false, suiteName, "timeout", &TimeoutGuard::describeTimedOut, &timedOut });
+        }
+        return false;
+    }
+    return passed;
+}
+
+inline void TimeoutGuard::reportNotRun() {
+    const std::size_t count = notRun.load(std::memory_order_relaxed);
+    Reporter& reporter = Reporter::current();
+    if (count == 0 || !reporter.wants(false)) {
+        return;
+    }
+    const bool suiteLimit = stoppedBySuite.load(std::memory_order_relaxed);
+    NotRun skipped{ count, suiteLimit, static_cast<double>(suiteLimit ? options.suiteTimeout.count() : options.assertionTimeout.count()) };
+    reporter.report({ false, suiteName, "timeout", &TimeoutGuard::describeNotRun, &skipped });
+}
+
+inline void TimeoutGuard::describeTimedOut(std::ostream& os, const void* context) {
+    const TimedOut& timedOut = *static_cast<const TimedOut*>(context);
+    os << "assertion #" << timedOut.index << " took " << timedOut.elapsedMs << " ms, "
+        << (timedOut.suiteLimit ? "ran past the suite limit of " : "limit ") << timedOut.limitMs << " ms";
+}
+
+inline void TimeoutGuard::describeNotRun(std::ostream& os, const void* context) {
+    const NotRun& skipped = *static_cast<const NotRun*>(context);
+    os << skipped.count << " assertions not run: "
+        << (skipped.suiteLimit ? "suite time limit of " : "stopped after an assertion exceeded ") << skipped.limitMs << " ms";
+}